@@ -18,6 +18,7 @@ Kirigami.FormLayout {
     property alias cfg_autoClipboard: autoClipboardCheckBox.checked
     property string cfg_defaultFormat
     property bool cfg_pickOnActivate
+    property int cfg_sampleSize
 
     QtControls.ComboBox {
         id: defaultFormatCombo
@@ -27,6 +28,22 @@ Kirigami.FormLayout {
         onActivated: cfg_defaultFormat = model[index]
     }
 
+    QtControls.ComboBox {
+        id: sampleSizeCombo
+        Kirigami.FormData.label: i18nc("@label:listbox", "Sample size:")
+        // only the X11 picker reads the screen on its own, elsewhere a single pixel is picked
+        visible: Qt.platform.pluginName === "xcb"
+        textRole: "text"
+        model: [
+            { text: i18nc("@item:inlistbox", "Single pixel"), size: 1 },
+            { text: i18nc("@item:inlistbox average of the pixels in a square", "3 × 3 average"), size: 3 },
+            { text: i18nc("@item:inlistbox average of the pixels in a square", "5 × 5 average"), size: 5 },
+            { text: i18nc("@item:inlistbox average of the pixels in a square", "11 × 11 average"), size: 11 }
+        ]
+        currentIndex: Math.max(0, model.findIndex(item => item.size === cfg_sampleSize))
+        onActivated: cfg_sampleSize = model[index].size
+    }
+
     QtControls.CheckBox {
         id: autoClipboardCheckBox
         text: i18nc("@option:check", "Automatically copy color to clipboard")
@@ -60,6 +60,7 @@ Item {
 
     ColorPicker.GrabWidget {
         id: picker
+        sampleSize: plasmoid.configuration.sampleSize
         onCurrentColorChanged: colorPicked(currentColor)
     }
 
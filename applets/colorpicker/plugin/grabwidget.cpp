@@ -14,10 +14,11 @@
 #include <QDBusPendingCall>
 #include <QDBusPendingCallWatcher>
 #include <QDBusPendingReply>
+#include <QCursor>
 #include <QDebug>
-#include <QDesktopWidget>
 #include <QEvent>
 #include <QMouseEvent>
+#include <QPainter>
 #include <QScreen>
 #include <QWidget>
 
@@ -43,6 +44,65 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, QColor &color)
     return argument;
 }
 
+// pixels shown around the cursor while picking and how much they are enlarged
+static const int MAGNIFIER_REGION = 15;
+static const int MAGNIFIER_ZOOM = 8;
+// distance of the magnifier from the cursor, it must not cover the sampled pixels
+static const int MAGNIFIER_OFFSET = 24;
+
+class Magnifier : public QWidget
+{
+public:
+    Magnifier()
+        : QWidget(nullptr, Qt::BypassWindowManagerHint | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint)
+    {
+        setFixedSize(MAGNIFIER_REGION * MAGNIFIER_ZOOM, MAGNIFIER_REGION * MAGNIFIER_ZOOM);
+        // the grabbed mouse reports moves without a pressed button only with tracking
+        setMouseTracking(true);
+        setAttribute(Qt::WA_OpaquePaintEvent);
+    }
+
+    void setImage(const QImage *image, const QPoint &cursor, int sampleSize)
+    {
+        m_image = image;
+        m_cursor = cursor;
+        m_sampleSize = sampleSize;
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        Q_UNUSED(event)
+
+        QPainter painter(this);
+        if (!m_image || m_image->isNull()) {
+            painter.fillRect(rect(), Qt::black);
+            return;
+        }
+
+        // without smooth transformation the pixels are enlarged as blocks
+        painter.drawImage(rect(), *m_image);
+
+        // frame the pixels the color is taken from, at the screen edges the cursor is not centered
+        const int cell = width() / m_image->width();
+        const int size = qMin(m_sampleSize, m_image->width());
+        const int left = qBound(0, m_cursor.x() - size / 2, m_image->width() - size);
+        const int top = qBound(0, m_cursor.y() - size / 2, m_image->height() - size);
+        const QRect sampled(left * cell, top * cell, size * cell, size * cell);
+        painter.setPen(Qt::white);
+        painter.drawRect(sampled.adjusted(-1, -1, 0, 0));
+        painter.setPen(Qt::black);
+        painter.drawRect(sampled.adjusted(-2, -2, 1, 1));
+        painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    }
+
+private:
+    const QImage *m_image = nullptr;
+    QPoint m_cursor;
+    int m_sampleSize = 1;
+};
+
 Grabber::Grabber(QObject *parent)
     : QObject(parent)
 {
@@ -50,6 +110,11 @@ Grabber::Grabber(QObject *parent)
 
 Grabber::~Grabber() = default;
 
+void Grabber::setSampleSize(int size)
+{
+    m_sampleSize = size;
+}
+
 void Grabber::setColor(const QColor &color)
 {
     if (m_color == color) {
@@ -61,9 +126,12 @@ void Grabber::setColor(const QColor &color)
 
 X11Grabber::X11Grabber(QObject *parent)
     : Grabber(parent)
-    , m_grabWidget(new QWidget(nullptr, Qt::BypassWindowManagerHint))
+    , m_grabWidget(new Magnifier)
 {
     m_grabWidget->move(-5000, -5000);
+
+    m_updateTimer.setSingleShot(true);
+    connect(&m_updateTimer, &QTimer::timeout, this, &X11Grabber::updateMagnifier);
 }
 
 X11Grabber::~X11Grabber()
@@ -75,6 +143,11 @@ void X11Grabber::pick()
 {
     // TODO pretend the mouse went somewhere else to prevent the tooltip from spawning
 
+    m_cursorPos = QCursor::pos();
+    const QScreen *screen = QGuiApplication::screenAt(m_cursorPos);
+    m_updateTimer.setInterval(screen && screen->refreshRate() > 0 ? qRound(1000 / screen->refreshRate()) : 16);
+    updateMagnifier();
+
     m_grabWidget->show();
     m_grabWidget->installEventFilter(this);
     m_grabWidget->grabMouse(Qt::CrossCursor);
@@ -89,15 +162,17 @@ bool X11Grabber::eventFilter(QObject *watched, QEvent *event)
         QMouseEvent *me = static_cast<QMouseEvent *>(event);
 
         if (me->button() == Qt::LeftButton) {
-            const QPoint pos = me->globalPos();
-            const QDesktopWidget *desktop = QApplication::desktop();
-            const QPixmap pixmap = QGuiApplication::screens().at(desktop->screenNumber())->grabWindow(desktop->winId(), pos.x(), pos.y(), 1, 1);
-            if (!pixmap.isNull()) {
-                QImage i = pixmap.toImage();
-                QColor color(i.pixel(0, 0));
-                setColor(color);
+            QPoint cursor;
+            const QImage &image = m_sampler.sample(me->globalPos(), sampleSize(), &cursor);
+            if (!image.isNull()) {
+                setColor(ScreenSampler::averageColor(image, cursor, sampleSize()));
             }
         }
+    } else if (watched == m_grabWidget && event->type() == QEvent::MouseMove) {
+        m_cursorPos = static_cast<QMouseEvent *>(event)->globalPos();
+        if (!m_updateTimer.isActive()) {
+            m_updateTimer.start();
+        }
     } else if (watched == m_grabWidget && event->type() == QEvent::KeyPress) {
         QKeyEvent *me = static_cast<QKeyEvent *>(event);
 
@@ -109,8 +184,29 @@ bool X11Grabber::eventFilter(QObject *watched, QEvent *event)
     return QObject::eventFilter(watched, event);
 }
 
+void X11Grabber::updateMagnifier()
+{
+    // the sampled region is taken before the magnifier moves, which keeps it out of the way
+    QPoint cursor;
+    const QImage &image = m_sampler.sample(m_cursorPos, qMax(MAGNIFIER_REGION, sampleSize()), &cursor);
+    m_grabWidget->setImage(&image, cursor, sampleSize());
+
+    QPoint pos = m_cursorPos + QPoint(MAGNIFIER_OFFSET, MAGNIFIER_OFFSET);
+    if (const QScreen *screen = QGuiApplication::screenAt(m_cursorPos)) {
+        const QRect geometry = screen->geometry();
+        if (pos.x() + m_grabWidget->width() > geometry.right()) {
+            pos.rx() = m_cursorPos.x() - MAGNIFIER_OFFSET - m_grabWidget->width();
+        }
+        if (pos.y() + m_grabWidget->height() > geometry.bottom()) {
+            pos.ry() = m_cursorPos.y() - MAGNIFIER_OFFSET - m_grabWidget->height();
+        }
+    }
+    m_grabWidget->move(pos);
+}
+
 void X11Grabber::releaseWidget()
 {
+    m_updateTimer.stop();
     m_grabWidget->removeEventFilter(this);
     m_grabWidget->hide();
     m_grabWidget->releaseMouse();
@@ -127,6 +223,12 @@ KWinWaylandGrabber::~KWinWaylandGrabber() = default;
 
 void KWinWaylandGrabber::pick()
 {
+    // KWin is already waiting for a click, which will answer this request as well
+    if (m_picking) {
+        return;
+    }
+    m_picking = true;
+
     QDBusMessage msg = QDBusMessage::createMethodCall(QStringLiteral("org.kde.KWin"),
                                                       QStringLiteral("/ColorPicker"),
                                                       QStringLiteral("org.kde.kwin.ColorPicker"),
@@ -135,6 +237,7 @@ void KWinWaylandGrabber::pick()
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
     connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
         watcher->deleteLater();
+        m_picking = false;
         QDBusPendingReply<QColor> reply = *watcher;
         if (!reply.isError()) {
             setColor(reply.value());
@@ -162,6 +265,25 @@ QColor GrabWidget::currentColor() const
     return m_grabber ? m_grabber->color() : QColor();
 }
 
+int GrabWidget::sampleSize() const
+{
+    return m_sampleSize;
+}
+
+void GrabWidget::setSampleSize(int size)
+{
+    // odd sizes only, so the region is centered at the cursor
+    size = qBound(1, size | 1, int(ScreenSampler::MaximumSize));
+    if (m_sampleSize == size) {
+        return;
+    }
+    m_sampleSize = size;
+    if (m_grabber) {
+        m_grabber->setSampleSize(size);
+    }
+    Q_EMIT sampleSizeChanged();
+}
+
 void GrabWidget::pick()
 {
     if (m_grabber) {
@@ -9,8 +9,12 @@
 
 #include <QColor>
 #include <QObject>
+#include <QPoint>
+#include <QTimer>
 
-class QWidget;
+#include "screensampler.h"
+
+class Magnifier;
 
 class Grabber : public QObject
 {
@@ -25,6 +29,15 @@ public:
         return m_color;
     }
 
+    /**
+     * The picked color is averaged over this many pixels per side, 1 picks a single pixel.
+     */
+    int sampleSize() const
+    {
+        return m_sampleSize;
+    }
+    void setSampleSize(int size);
+
 Q_SIGNALS:
     void colorChanged();
 
@@ -34,6 +47,7 @@ protected:
 
 private:
     QColor m_color;
+    int m_sampleSize = 1;
 };
 
 class X11Grabber : public Grabber
@@ -50,8 +64,14 @@ protected:
 
 private:
     void releaseWidget();
-
-    QWidget *m_grabWidget;
+    void updateMagnifier();
+
+    // shows the pixels around the cursor while picking, also receives the grabbed input
+    Magnifier *m_grabWidget;
+    ScreenSampler m_sampler;
+    QPoint m_cursorPos;
+    // limits the magnifier updates to the refresh rate of the screen
+    QTimer m_updateTimer;
 };
 
 class KWinWaylandGrabber : public Grabber
@@ -61,7 +81,14 @@ public:
     explicit KWinWaylandGrabber(QObject *parent = nullptr);
     ~KWinWaylandGrabber() override;
 
+    /**
+     * KWin picks a single pixel interactively, the sample size is not supported.
+     * Picking again while KWin still waits for the click does not start another pick.
+     */
     void pick() override;
+
+private:
+    bool m_picking = false;
 };
 
 class GrabWidget : public QObject
@@ -69,6 +96,7 @@ class GrabWidget : public QObject
     Q_OBJECT
 
     Q_PROPERTY(QColor currentColor READ currentColor NOTIFY currentColorChanged)
+    Q_PROPERTY(int sampleSize READ sampleSize WRITE setSampleSize NOTIFY sampleSizeChanged)
 
 public:
     explicit GrabWidget(QObject *parent = nullptr);
@@ -76,14 +104,19 @@ public:
 
     QColor currentColor() const;
 
+    int sampleSize() const;
+    void setSampleSize(int size);
+
     Q_INVOKABLE void pick();
     Q_INVOKABLE void copyToClipboard(const QString &text);
 
 Q_SIGNALS:
     void currentColorChanged();
+    void sampleSizeChanged();
 
 private:
     Grabber *m_grabber = nullptr;
+    int m_sampleSize = 1;
 };
 
 #endif // GRABWIDGET_H
@@ -0,0 +1,177 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "screensampler.h"
+
+#include <QGuiApplication>
+#include <QPixmap>
+#include <QScreen>
+
+#ifdef HAVE_XCB_SHM
+#include <QX11Info>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <xcb/shm.h>
+#include <xcb/xcb.h>
+#endif
+
+struct ScreenSampler::Shm {
+#ifdef HAVE_XCB_SHM
+    xcb_connection_t *connection = nullptr;
+    xcb_window_t root = XCB_WINDOW_NONE;
+    xcb_shm_seg_t segment = 0;
+    uchar *buffer = nullptr;
+#endif
+};
+
+ScreenSampler::ScreenSampler()
+{
+#ifdef HAVE_XCB_SHM
+    if (!QX11Info::isPlatformX11()) {
+        return;
+    }
+
+    xcb_connection_t *connection = QX11Info::connection();
+    const xcb_query_extension_reply_t *extension = xcb_get_extension_data(connection, &xcb_shm_id);
+    if (!extension || !extension->present) {
+        return;
+    }
+
+    const int id = shmget(IPC_PRIVATE, MaximumSize * MaximumSize * 4, IPC_CREAT | 0600);
+    if (id < 0) {
+        return;
+    }
+    void *buffer = shmat(id, nullptr, 0);
+    if (buffer == reinterpret_cast<void *>(-1)) {
+        shmctl(id, IPC_RMID, nullptr);
+        return;
+    }
+
+    const xcb_shm_seg_t segment = xcb_generate_id(connection);
+    xcb_generic_error_t *error = xcb_request_check(connection, xcb_shm_attach_checked(connection, segment, id, false));
+    // the segment goes away once both sides detached it
+    shmctl(id, IPC_RMID, nullptr);
+    if (error) {
+        // e.g. a remote X server which can not share memory with us
+        free(error);
+        shmdt(buffer);
+        return;
+    }
+
+    m_shm = new Shm;
+    m_shm->connection = connection;
+    m_shm->root = QX11Info::appRootWindow();
+    m_shm->segment = segment;
+    m_shm->buffer = static_cast<uchar *>(buffer);
+#endif
+}
+
+ScreenSampler::~ScreenSampler()
+{
+#ifdef HAVE_XCB_SHM
+    if (m_shm) {
+        // the image must not outlive the buffer it refers to
+        m_image = QImage();
+        xcb_shm_detach(m_shm->connection, m_shm->segment);
+        xcb_flush(m_shm->connection);
+        shmdt(m_shm->buffer);
+    }
+#endif
+    delete m_shm;
+}
+
+const QImage &ScreenSampler::sample(const QPoint &pos, int size, QPoint *cursor)
+{
+    size = qBound(1, size, int(MaximumSize));
+
+    QPoint cursorInImage;
+    if (!cursor) {
+        cursor = &cursorInImage;
+    }
+
+    if (m_shm && sampleShm(pos, size, cursor)) {
+        return m_image;
+    }
+
+    QScreen *screen = QGuiApplication::screenAt(pos);
+    if (!screen) {
+        screen = QGuiApplication::primaryScreen();
+    }
+    const QRect geometry = screen->virtualGeometry();
+    const int x = qBound(geometry.left(), pos.x() - size / 2, geometry.right() + 1 - size);
+    const int y = qBound(geometry.top(), pos.y() - size / 2, geometry.bottom() + 1 - size);
+    *cursor = pos - QPoint(x, y);
+
+    // window id 0 is the root window, which covers all screens
+    const QPixmap pixmap = screen->grabWindow(0, x, y, size, size);
+    m_image = pixmap.isNull() ? QImage() : pixmap.toImage().convertToFormat(QImage::Format_RGB32);
+    return m_image;
+}
+
+bool ScreenSampler::sampleShm(const QPoint &pos, int size, QPoint *cursor)
+{
+#ifdef HAVE_XCB_SHM
+    // the X server knows only device pixels
+    const qreal ratio = qGuiApp->devicePixelRatio();
+    const QRect geometry(QGuiApplication::primaryScreen()->virtualGeometry().topLeft() * ratio,
+                         QGuiApplication::primaryScreen()->virtualGeometry().size() * ratio);
+    const QPoint nativePos = pos * ratio;
+    const int x = qBound(geometry.left(), nativePos.x() - size / 2, geometry.right() + 1 - size);
+    const int y = qBound(geometry.top(), nativePos.y() - size / 2, geometry.bottom() + 1 - size);
+    *cursor = nativePos - QPoint(x, y);
+
+    const xcb_shm_get_image_cookie_t cookie =
+        xcb_shm_get_image_unchecked(m_shm->connection, m_shm->root, x, y, size, size, ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, m_shm->segment, 0);
+    xcb_shm_get_image_reply_t *reply = xcb_shm_get_image_reply(m_shm->connection, cookie, nullptr);
+    if (!reply) {
+        return false;
+    }
+    // only 32 bit per pixel layouts can be used without converting
+    const bool usable = reply->depth == 24 || reply->depth == 32;
+    free(reply);
+    if (!usable) {
+        return false;
+    }
+
+    // wraps the shared memory without copying, only redone when the size changes
+    if (m_image.width() != size || m_image.constBits() != m_shm->buffer) {
+        m_image = QImage(m_shm->buffer, size, size, size * 4, QImage::Format_RGB32);
+    }
+    return true;
+#else
+    Q_UNUSED(pos)
+    Q_UNUSED(size)
+    Q_UNUSED(cursor)
+    return false;
+#endif
+}
+
+QColor ScreenSampler::averageColor(const QImage &image, const QPoint &center, int size)
+{
+    if (image.isNull()) {
+        return QColor();
+    }
+
+    size = qBound(1, size, qMin(image.width(), image.height()));
+    const int left = qBound(0, center.x() - size / 2, image.width() - size);
+    const int top = qBound(0, center.y() - size / 2, image.height() - size);
+
+    quint32 red = 0;
+    quint32 green = 0;
+    quint32 blue = 0;
+    for (int y = top; y < top + size; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y)) + left;
+        for (int x = 0; x < size; ++x) {
+            red += qRed(line[x]);
+            green += qGreen(line[x]);
+            blue += qBlue(line[x]);
+        }
+    }
+
+    const quint32 count = size * size;
+    return QColor(red / count, green / count, blue / count);
+}
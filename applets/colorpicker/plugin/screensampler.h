@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SCREENSAMPLER_H
+#define SCREENSAMPLER_H
+
+#include <QColor>
+#include <QImage>
+#include <QPoint>
+
+/**
+ * Reads small square regions of the X11 screen.
+ *
+ * With the MIT-SHM extension the pixels are transferred through a shared
+ * memory segment which is set up once and reused for every read, so
+ * sampling repeatedly, e.g. for a magnifier following the cursor, does not
+ * allocate. Without it, the screen is grabbed through QScreen.
+ */
+class ScreenSampler
+{
+public:
+    /**
+     * The largest region that can be read at once, in pixels per side.
+     */
+    static constexpr int MaximumSize = 31;
+
+    ScreenSampler();
+    ~ScreenSampler();
+    Q_DISABLE_COPY(ScreenSampler)
+
+    /**
+     * Reads the @p size × @p size region centered at @p pos, given in global
+     * coordinates. The region is moved inside the screen if needed, so near
+     * the screen edges @p pos is not in its center. If @p cursor is given, it
+     * is set to the position of @p pos inside the image.
+     *
+     * The returned image shares the internal buffer and stays valid until
+     * the next call. It is null if the screen could not be read.
+     */
+    const QImage &sample(const QPoint &pos, int size, QPoint *cursor = nullptr);
+
+    /**
+     * Returns the average color of the @p size × @p size pixels of @p image
+     * around @p center, as far as they are inside the image.
+     */
+    static QColor averageColor(const QImage &image, const QPoint &center, int size);
+
+private:
+    bool sampleShm(const QPoint &pos, int size, QPoint *cursor);
+
+    QImage m_image;
+
+    // Keeps the xcb types out of the header
+    struct Shm;
+    Shm *m_shm = nullptr;
+};
+
+#endif // SCREENSAMPLER_H
@@ -6,12 +6,17 @@
 
 #include "checknewstrips.h"
 
+#include "comicsources.h"
+
 #include <QTimer>
 
+// number of comics that are checked at the same time
+static const int MAX_RUNNING_CHECKS = 4;
+
 CheckNewStrips::CheckNewStrips(const QStringList &identifiers, Plasma::DataEngine *engine, int minutes, QObject *parent)
     : QObject(parent)
     , mMinutes(minutes)
-    , mIndex(0)
+    , mRunning(0)
     , mEngine(engine)
     , mIdentifiers(identifiers)
 {
@@ -26,39 +31,44 @@ CheckNewStrips::CheckNewStrips(const QStringList &identifiers, Plasma::DataEngin
 
 void CheckNewStrips::dataUpdated(const QString &source, const Plasma::DataEngine::Data &data)
 {
+    const QString identifier = source.mid(ComicSources::PROBE_PREFIX.size());
     QString lastIdentifierSuffix;
 
+    // probes do not download the image, so a new strip is only recognised by its identifier
     if (!data[QStringLiteral("Error")].toBool()) {
         lastIdentifierSuffix = data[QStringLiteral("Identifier")].toString();
-        lastIdentifierSuffix.remove(source);
+        lastIdentifierSuffix.remove(identifier + QLatin1Char(':'));
     }
 
     mEngine->disconnectSource(source, this);
+    --mRunning;
 
     if (!lastIdentifierSuffix.isEmpty()) {
-        QString temp = source;
-        temp.remove(QLatin1Char(':'));
-        Q_EMIT lastStrip(mIndex, temp, lastIdentifierSuffix);
+        Q_EMIT lastStrip(mIdentifiers.indexOf(identifier), identifier, lastIdentifierSuffix);
     }
-    ++mIndex;
 
-    if (mIndex < mIdentifiers.count()) {
-        const QString newSource = mIdentifiers[mIndex] + QLatin1Char(':');
-        mEngine->connectSource(newSource, this);
-    } else {
-        mIndex = 0;
-    }
+    checkNext();
 }
 
 void CheckNewStrips::start()
 {
     // already running, do nothing
-    if (mIndex) {
+    if (mRunning || !mPending.isEmpty()) {
         return;
     }
 
-    if (mIndex < mIdentifiers.count()) {
-        const QString newSource = mIdentifiers[mIndex] + QLatin1Char(':');
-        mEngine->connectSource(newSource, this);
+    mPending = mIdentifiers;
+    while (mRunning < MAX_RUNNING_CHECKS && !mPending.isEmpty()) {
+        checkNext();
     }
 }
+
+void CheckNewStrips::checkNext()
+{
+    if (mPending.isEmpty()) {
+        return;
+    }
+
+    ++mRunning;
+    mEngine->connectSource(ComicSources::PROBE_PREFIX + mPending.takeFirst(), this);
+}
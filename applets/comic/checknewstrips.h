@@ -12,6 +12,8 @@
 /**
  * This class searches for the newest comic strips of predefined comics in a defined interval.
  * Once found it emits lastStrip
+ *
+ * Only the identifiers of the latest strips are probed, a few comics at a time.
  */
 class CheckNewStrips : public QObject
 {
@@ -36,10 +38,13 @@ private Q_SLOTS:
     void start();
 
 private:
+    void checkNext();
+
     int mMinutes;
-    int mIndex;
+    int mRunning;
     Plasma::DataEngine *mEngine;
     const QStringList mIdentifiers;
+    QStringList mPending;
 };
 
 #endif
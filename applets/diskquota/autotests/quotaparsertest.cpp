@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "QuotaParser.h"
+
+#include <QTest>
+
+using namespace QuotaParser;
+
+class QuotaParserTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testMounts();
+    void testQuotaOutput();
+    void benchmarkMounts();
+    void benchmarkQuotaOutput();
+};
+
+void QuotaParserTest::testMounts()
+{
+    const QByteArray table =
+        "/dev/sda2 / ext4 rw,relatime 0 0\n"
+        "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n"
+        "server:/export/home\\040dir /home/with\\040space nfs4 rw,relatime 0 0\n"
+        "\n"
+        "# comment\n"
+        "/dev/sdb1 /data xfs rw 0 0";
+
+    const QVector<Mount> mounts = parseMounts(table);
+    QCOMPARE(mounts.count(), 4);
+    QCOMPARE(mounts[0].device, QStringLiteral("/dev/sda2"));
+    QCOMPARE(mounts[0].mountPoint, QStringLiteral("/"));
+    QCOMPARE(mounts[0].type, QStringLiteral("ext4"));
+    QCOMPARE(mounts[2].device, QStringLiteral("server:/export/home dir"));
+    QCOMPARE(mounts[2].mountPoint, QStringLiteral("/home/with space"));
+    QCOMPARE(mounts[2].type, QStringLiteral("nfs4"));
+    QCOMPARE(mounts[3].mountPoint, QStringLiteral("/data"));
+}
+
+void QuotaParserTest::testQuotaOutput()
+{
+    const QString output = QStringLiteral(
+        "Disk quotas for user dh (uid 1000):\n"
+        "     Filesystem   blocks  quota    limit     grace   files    quota   limit   grace\n"
+        "      /home     16296500  50000000 60000000          389155       0       0\r\n"
+        "      /home/archive     16296500* 50000000 60000000      6   389155       0       0\n"
+        "      /broken 12\n");
+
+    const QVector<Quota> quotas = parseQuotaOutput(output);
+    QCOMPARE(quotas.count(), 2);
+    QCOMPARE(quotas[0].mountPoint, QStringLiteral("/home"));
+    QCOMPARE(quotas[0].used, Q_INT64_C(16296500) * 1024);
+    QCOMPARE(quotas[0].softLimit, Q_INT64_C(50000000) * 1024);
+    QCOMPARE(quotas[0].hardLimit, Q_INT64_C(60000000) * 1024);
+    QCOMPARE(quotas[1].mountPoint, QStringLiteral("/home/archive"));
+    QCOMPARE(quotas[1].used, Q_INT64_C(16296500) * 1024);
+}
+
+void QuotaParserTest::benchmarkMounts()
+{
+    // machines with many containers or automounted shares easily have thousands of mounts
+    QByteArray table;
+    for (int i = 0; i < 5000; ++i) {
+        table += "server" + QByteArray::number(i % 20) + ":/export/user" + QByteArray::number(i) + " /home/user" + QByteArray::number(i)
+            + " nfs4 rw,relatime,vers=4.2,rsize=1048576,wsize=1048576,namlen=255,hard,proto=tcp 0 0\n";
+    }
+
+    int count = 0;
+    QBENCHMARK {
+        count = parseMounts(table).count();
+    }
+    QCOMPARE(count, 5000);
+}
+
+void QuotaParserTest::benchmarkQuotaOutput()
+{
+    QString output = QStringLiteral("Disk quotas for user dh (uid 1000):\n");
+    for (int i = 0; i < 5000; ++i) {
+        output += QStringLiteral("      /home/user%1     16296500* 50000000 60000000      6   389155       0       0\n").arg(i);
+    }
+
+    int count = 0;
+    QBENCHMARK {
+        count = parseQuotaOutput(output).count();
+    }
+    QCOMPARE(count, 5000);
+}
+
+QTEST_GUILESS_MAIN(QuotaParserTest)
+
+#include "quotaparsertest.moc"
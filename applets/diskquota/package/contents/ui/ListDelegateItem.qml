@@ -21,6 +21,7 @@ PlasmaComponents.ListItem {
     property string usedString
     property string freeString
     property int usage
+    property string prediction
 
     onContainsMouseChanged: {
         if (containsMouse) {
@@ -81,6 +82,12 @@ PlasmaComponents.ListItem {
                 text: usedString
                 opacity: 0.6
             }
+            PlasmaComponents3.Label {
+                anchors.left: parent.left
+                visible: prediction !== ""
+                text: prediction
+                opacity: 0.6
+            }
         }
     }
 }
@@ -88,6 +88,7 @@ Item {
                     usedString: model.used
                     freeString: model.free
                     usage: model.usage
+                    prediction: model.prediction
                 }
             }
         }
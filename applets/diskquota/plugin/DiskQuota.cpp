@@ -4,27 +4,42 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 #include "DiskQuota.h"
+#include "QuotaCollector.h"
 #include "QuotaItem.h"
 #include "QuotaListModel.h"
 
 #include <KFormat>
 #include <KLocalizedString>
 
-#include <QRegularExpression>
+#include <QProcess>
 #include <QStandardPaths>
+#include <QThreadPool>
 #include <QTimer>
+
+#include <algorithm>
 // #include <QDebug>
 
+// installing or removing the tools is rare, look them up only this often (ms)
+static const qint64 EXECUTABLE_RECHECK = 30 * 60 * 1000;
+// a single 'quota' process is given up after this many ms
+static const int PROCESS_TIMEOUT = 15 * 1000;
+// update intervals in ms, depending on how close the quota is to its limit
+static const int MIN_INTERVAL = 30 * 1000;
+static const int MAX_INTERVAL = 10 * 60 * 1000;
+// weight of the latest measurement in the smoothed usage rate
+static const double RATE_SMOOTHING = 0.5;
+// predictions further ahead than this many ms are not shown
+static const qint64 PREDICTION_HORIZON = 24 * 60 * 60 * 1000;
+
 DiskQuota::DiskQuota(QObject *parent)
     : QObject(parent)
     , m_timer(new QTimer(this))
-    , m_quotaProcess(new QProcess(this))
     , m_model(new QuotaListModel(this))
 {
+    // rescheduled after every update, see scheduleUpdate()
+    m_timer->setSingleShot(true);
     connect(m_timer, &QTimer::timeout, this, &DiskQuota::updateQuota);
-    m_timer->start(2 * 60 * 1000); // check every 2 minutes
-
-    connect(m_quotaProcess, (void (QProcess::*)(int, QProcess::ExitStatus)) & QProcess::finished, this, &DiskQuota::quotaProcessFinished);
+    m_clock.start();
 
     updateQuota();
 }
@@ -129,35 +144,77 @@ static QString iconNameForQuota(int quota)
     return QStringLiteral("disk-quota-critical");
 }
 
-static bool isQuotaLine(const QString &line)
+void DiskQuota::updateExecutables()
 {
-    const int iMax = line.size();
-    for (int i = 0; i < iMax; ++i) {
-        if (!line[i].isSpace() && line[i] == QLatin1Char('/')) {
-            return true;
-        }
+    if (m_executablesChecked.isValid() && !m_executablesChecked.hasExpired(EXECUTABLE_RECHECK)) {
+        return;
     }
-    return false;
+    m_executablesChecked.start();
+
+    m_quotaExecutable = QStandardPaths::findExecutable(QStringLiteral("quota"));
+
+    // for now, only filelight is supported
+    setCleanUpToolInstalled(!QStandardPaths::findExecutable(QStringLiteral("filelight")).isEmpty());
 }
 
 void DiskQuota::updateQuota()
 {
-    const bool quotaFound = !QStandardPaths::findExecutable(QStringLiteral("quota")).isEmpty();
+    // every 'quota' process is bounded by a timeout, so a previous update finishes eventually
+    if (m_collector || m_runningProcesses > 0) {
+        return;
+    }
+
+    m_timer->stop();
+    updateExecutables();
+
+    const bool quotaFound = QuotaCollector::isSupported() || !m_quotaExecutable.isEmpty();
     setQuotaInstalled(quotaFound);
     if (!quotaFound) {
+        m_timer->start(MAX_INTERVAL);
         return;
     }
 
-    // for now, only filelight is supported
-    setCleanUpToolInstalled(!QStandardPaths::findExecutable(QStringLiteral("filelight")).isEmpty());
+    m_collectedQuotas.clear();
+    m_failedProcesses = 0;
+    m_missingQuotaTool = false;
+
+    if (!QuotaCollector::isSupported()) {
+        startQuotaProcess(QString());
+        return;
+    }
+
+    m_collector = new QuotaCollector;
+    connect(m_collector, &QuotaCollector::finished, this, &DiskQuota::collectorFinished);
+    connect(m_collector, &QuotaCollector::finished, m_collector, &QObject::deleteLater);
+    QThreadPool::globalInstance()->start(m_collector);
+}
+
+void DiskQuota::collectorFinished()
+{
+    m_collectedQuotas = m_collector->quotas();
+    const QStringList fallbackMountPoints = m_collector->fallbackMountPoints();
+    const bool hasMountTable = m_collector->hasMountTable();
+    m_collector = nullptr;
+
+    m_missingQuotaTool = m_quotaExecutable.isEmpty() && (!hasMountTable || !fallbackMountPoints.isEmpty());
+    if (!m_quotaExecutable.isEmpty()) {
+        if (!hasMountTable) {
+            startQuotaProcess(QString());
+        }
+        // each mount point gets its own process, one unresponsive server does not delay the others
+        for (const QString &mountPoint : fallbackMountPoints) {
+            startQuotaProcess(mountPoint);
+        }
+    }
 
-    // kill running process in case it hanged for whatever reason
-    if (m_quotaProcess->state() != QProcess::NotRunning) {
-        m_quotaProcess->kill();
+    if (m_runningProcesses == 0) {
+        publishQuota();
     }
+}
 
-    // Try to run 'quota'
-    const QStringList args{
+void DiskQuota::startQuotaProcess(const QString &mountPoint)
+{
+    QStringList args{
         QStringLiteral("--show-mntpoint"), // second entry is e.g. '/home'
         QStringLiteral("--hide-device"), // hide e.g. /dev/sda3
         QStringLiteral("--no-mixed-pathnames"), // trim leading slashes from NFSv4 mountpoints
@@ -165,88 +222,117 @@ void DiskQuota::updateQuota()
         QStringLiteral("--no-wrap"), // do not wrap long lines
         QStringLiteral("--quiet-refuse"), // no not print error message when NFS server does not respond
     };
+    if (!mountPoint.isEmpty()) {
+        args << QStringLiteral("--filesystem=") + mountPoint;
+    }
 
-    m_quotaProcess->start(QStringLiteral("quota"), args, QIODevice::ReadOnly);
+    auto *process = new QProcess(this);
+    ++m_runningProcesses;
+
+    auto done = [this, process](bool success) {
+        process->disconnect(this);
+        if (success) {
+            m_collectedQuotas += QuotaParser::parseQuotaOutput(QString::fromLocal8Bit(process->readAllStandardOutput()));
+        } else {
+            ++m_failedProcesses;
+        }
+        if (--m_runningProcesses == 0) {
+            publishQuota();
+        }
+    };
+
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [process, done](int exitCode, QProcess::ExitStatus exitStatus) {
+        Q_UNUSED(exitCode)
+        done(exitStatus == QProcess::NormalExit);
+        process->deleteLater();
+    });
+    connect(process, &QProcess::errorOccurred, this, [process, done](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            done(false);
+            process->deleteLater();
+        }
+    });
+    QTimer::singleShot(PROCESS_TIMEOUT, process, [process, done]() {
+        if (process->state() == QProcess::NotRunning) {
+            return;
+        }
+        // A process stuck on a hung NFS mount might not even die right away,
+        // waiting for it in the QProcess destructor would block the shell.
+        done(false);
+        connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), process, &QObject::deleteLater);
+        process->kill();
+    });
+
+    process->start(m_quotaExecutable, args, QIODevice::ReadOnly);
 }
 
-void DiskQuota::quotaProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void DiskQuota::publishQuota()
 {
-    Q_UNUSED(exitCode)
-
-    if (exitStatus != QProcess::NormalExit) {
+    if (m_collectedQuotas.isEmpty() && m_failedProcesses > 0) {
         m_model->clear();
         setToolTip(i18n("Disk Quota"));
         setSubToolTip(i18n("Running quota failed"));
+        m_timer->start(MAX_INTERVAL);
         return;
     }
 
-    // get quota output
-    const QString rawData = QString::fromLocal8Bit(m_quotaProcess->readAllStandardOutput());
-    //     qDebug() << rawData;
-
-    const QStringList lines = rawData.split(QRegularExpression(QStringLiteral("[\r\n]")), Qt::SkipEmptyParts);
-    // Testing
-    //     QStringList lines = QStringList()
-    //         << QStringLiteral("/home/peterpan 3975379*  5000000 7000000           57602 0       0")
-    //         << QStringLiteral("/home/archive 2263536  6000000 5100000            3932 0       0")
-    //         << QStringLiteral("/home/shared 4271196*  10000000 7000000           57602 0       0");
-    //         << QStringLiteral("/home/peterpan %1*  5000000 7000000           57602 0       0").arg(qrand() % 5000000)
-    //         << QStringLiteral("/home/archive %1  5000000 5100000            3932 0       0").arg(qrand() % 5000000)
-    //         << QStringLiteral("/home/shared %1*  5000000 7000000           57602 0       0").arg(qrand() % 5000000);
-    //     lines.removeAt(qrand() % lines.size());
+    // local file systems and NFS shares are collected separately, keep a stable order
+    std::sort(m_collectedQuotas.begin(), m_collectedQuotas.end(), [](const QuotaParser::Quota &a, const QuotaParser::Quota &b) {
+        return a.mountPoint < b.mountPoint;
+    });
 
     // format class needed for GiB/MiB/KiB formatting
     KFormat fmt;
     int maxQuota = 0;
+    int maxUsage = 0;
+    qint64 minTimeLeft = -1;
+    QString nextOutOfQuota;
     QVector<QuotaItem> items;
+    items.reserve(m_collectedQuotas.size());
+    QHash<QString, UsageTrend> oldTrends;
+    oldTrends.swap(m_trends);
 
-    // assumption: Filesystem starts with slash
-    for (const QString &line : lines) {
-        //         qDebug() << line << isQuotaLine(line);
-        if (!isQuotaLine(line)) {
-            continue;
+    for (const QuotaParser::Quota &quota : qAsConst(m_collectedQuotas)) {
+        const qint64 used = quota.used;
+        qint64 softLimit = quota.softLimit;
+        if (softLimit == 0) { // softLimit might be unused (0)
+            softLimit = quota.hardLimit;
         }
-
-        QStringList parts = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
-        // valid lines range from 7 to 9 parts (grace not always there):
-        // Disk quotas for user dh (uid 1000):
-        //      Filesystem   blocks  quota    limit     grace   files    quota   limit   grace
-        //       /home     16296500  50000000 60000000          389155       0       0
-        //       /home     16296500* 50000000 60000000      6   389155       0       0
-        //       /home     16296500* 50000000 60000000      4   389155       0       0       5
-        //       ^...........we want these...........^
-        // NOTE: In case of a soft limit violation, a '*' is added in the used blocks.
-        //       Hence, the star is removed below, if applicable
-
-        if (parts.size() < 4) {
+        if (softLimit == 0) {
             continue;
         }
 
-        // 'quota' uses kilo bytes -> factor 1024
-        // NOTE: int is not large enough, hence qint64
-        const qint64 used = parts[1].remove(QLatin1Char('*')).toLongLong() * 1024;
-        qint64 softLimit = parts[2].toLongLong() * 1024;
-        const qint64 hardLimit = parts[3].toLongLong() * 1024;
-        if (softLimit == 0) { // softLimit might be unused (0)
-            softLimit = hardLimit;
-        }
+        m_trends.insert(quota.mountPoint, oldTrends.value(quota.mountPoint));
+        const qint64 timeLeft = updateTrend(quota);
+
         const qint64 freeSize = softLimit - used;
         const int percent = qMin(100, qMax(0, qRound(used * 100.0 / softLimit)));
 
         QuotaItem item;
         item.setIconName(iconNameForQuota(percent));
-        item.setMountPoint(parts[0]);
+        item.setMountPoint(quota.mountPoint);
         item.setUsage(percent);
-        item.setMountString(i18nc("usage of quota, e.g.: '/home/bla: 38% used'", "%1: %2% used", parts[0], percent));
+        item.setMountString(i18nc("usage of quota, e.g.: '/home/bla: 38% used'", "%1: %2% used", quota.mountPoint, percent));
         item.setUsedString(i18nc("e.g.: 12 GiB of 20 GiB", "%1 of %2", fmt.formatByteSize(used), fmt.formatByteSize(softLimit)));
         item.setFreeString(i18nc("e.g.: 8 GiB free", "%1 free", fmt.formatByteSize(qMax(qint64(0), freeSize))));
+        if (timeLeft >= 0 && timeLeft < PREDICTION_HORIZON) {
+            const int minutes = qMax(1, qRound(timeLeft / 60000.0));
+            item.setPredictionString(minutes < 120 ? i18ncp("prediction of the quota usage", "Out of quota in ~%1 minute", "Out of quota in ~%1 minutes", minutes)
+                                                   : i18ncp("prediction of the quota usage", "Out of quota in ~%1 hour", "Out of quota in ~%1 hours", qRound(minutes / 60.0)));
+            if (minTimeLeft < 0 || timeLeft < minTimeLeft) {
+                minTimeLeft = timeLeft;
+                nextOutOfQuota = i18nc("e.g.: '/home: Out of quota in ~5 minutes'", "%1: %2", quota.mountPoint, item.predictionString());
+            }
+        }
 
         items.append(item);
 
         maxQuota = qMax(maxQuota, percent);
+        // the hard limit counts as well, it might be the only one or the closer one
+        const qint64 hardLimit = quota.hardLimit > 0 ? quota.hardLimit : softLimit;
+        maxUsage = qMax(maxUsage, qRound(used * 100.0 / qMin(softLimit, hardLimit)));
     }
-
-    //     qDebug() << "QUOTAS:" << quotas;
+    m_collectedQuotas.clear();
 
     // make sure max quota is 100. Could be more, due to the
     // hard limit > soft limit, and we take soft limit as 100%
@@ -260,14 +346,64 @@ void DiskQuota::quotaProcessFinished(int exitCode, QProcess::ExitStatus exitStat
 
     if (!items.isEmpty()) {
         setToolTip(i18nc("example: Quota: 83% used", "Quota: %1% used", maxQuota));
-        setSubToolTip(QString());
     } else {
         setToolTip(i18n("Disk Quota"));
+    }
+    // a quota running out soon matters more than the ones that could not be looked at
+    if (!nextOutOfQuota.isEmpty()) {
+        setSubToolTip(nextOutOfQuota);
+    } else if (m_missingQuotaTool) {
+        setSubToolTip(i18n("Please install 'quota'"));
+    } else if (items.isEmpty()) {
         setSubToolTip(i18n("No quota restrictions found."));
+    } else {
+        setSubToolTip(QString());
     }
 
     // merge new items, add new ones, remove old ones
     m_model->updateItems(items);
+
+    scheduleUpdate(maxUsage, minTimeLeft);
+}
+
+qint64 DiskQuota::updateTrend(const QuotaParser::Quota &quota)
+{
+    UsageTrend &trend = m_trends[quota.mountPoint];
+    const qint64 now = m_clock.elapsed();
+
+    if (trend.time >= 0 && now > trend.time) {
+        const double rate = double(quota.used - trend.used) / (now - trend.time);
+        trend.rate = trend.hasRate ? RATE_SMOOTHING * rate + (1.0 - RATE_SMOOTHING) * trend.rate : rate;
+        trend.hasRate = true;
+    }
+    trend.used = quota.used;
+    trend.time = now;
+
+    // writing fails at the hard limit, the soft one can be exceeded for a grace period
+    const qint64 limit = quota.hardLimit > 0 ? quota.hardLimit : quota.softLimit;
+    if (!trend.hasRate || trend.rate <= 0.0 || quota.used >= limit) {
+        return -1;
+    }
+    return qint64((limit - quota.used) / trend.rate);
+}
+
+void DiskQuota::scheduleUpdate(int usage, qint64 timeLeft)
+{
+    int interval = MAX_INTERVAL;
+    if (usage >= 90) {
+        interval = MIN_INTERVAL;
+    } else if (usage >= 75) {
+        interval = 2 * 60 * 1000;
+    } else if (usage >= 50) {
+        interval = 5 * 60 * 1000;
+    }
+
+    // look again well before the quota is predicted to run out
+    if (timeLeft >= 0) {
+        interval = int(qBound(qint64(MIN_INTERVAL), timeLeft / 4, qint64(interval)));
+    }
+
+    m_timer->start(interval);
 }
 
 QuotaListModel *DiskQuota::model() const
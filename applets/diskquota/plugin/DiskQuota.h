@@ -6,16 +6,22 @@
 #ifndef PLASMA_DISK_QUOTA_H
 #define PLASMA_DISK_QUOTA_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
-#include <QProcess>
+#include <QVector>
+
+#include "QuotaParser.h"
 
 class QTimer;
+class QuotaCollector;
 class QuotaListModel;
 
 /**
  * Class monitoring the file system quota.
- * The monitoring is performed through a timer, running the 'quota'
- * command line tool.
+ * The monitoring is performed through a timer, reading the quota of local
+ * file systems directly and running the 'quota' command line tool for the
+ * remaining ones, e.g. NFS shares.
  */
 class DiskQuota : public QObject
 {
@@ -72,16 +78,11 @@ public:
 public Q_SLOTS:
     /**
      * Called every timer timeout to update the data model.
-     * Launches an asynchronous 'quota' process to obtain data,
-     * and finally calls quotaProcessFinished().
+     * Collects the quota asynchronously and finally calls publishQuota().
+     * Does nothing while a previous update is still running.
      */
     void updateQuota();
 
-    /**
-     * Processes the quota data from the 'quota' process.
-     */
-    void quotaProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
-
     /**
      * Opens the cleanup tool (filelight) at the folder @p mountPoint.
      */
@@ -96,8 +97,61 @@ Q_SIGNALS:
     void iconNameChanged();
 
 private:
+    /**
+     * Looks up the 'quota' and cleanup tool executables again once in a while.
+     */
+    void updateExecutables();
+
+    /**
+     * Takes over the quotas of the local file systems and starts 'quota'
+     * for those which could not be queried directly.
+     */
+    void collectorFinished();
+
+    /**
+     * Runs 'quota' for @p mountPoint, or for all file systems if it is empty.
+     * The process is given up after a timeout to not wait for unresponsive NFS servers.
+     */
+    void startQuotaProcess(const QString &mountPoint);
+
+    /**
+     * Updates the model and the tray status with the collected quotas.
+     */
+    void publishQuota();
+
+    /**
+     * Estimates the time in ms until the usage of @p quota reaches its limit,
+     * based on the usage rate seen so far. Returns -1 if the usage does not grow.
+     */
+    qint64 updateTrend(const QuotaParser::Quota &quota);
+
+    /**
+     * Schedules the next update, sooner the closer any quota is to its limit.
+     */
+    void scheduleUpdate(int usage, qint64 timeLeft = -1);
+
+    /**
+     * Usage of one mount point at the last update.
+     */
+    struct UsageTrend {
+        qint64 used = 0;
+        qint64 time = -1;
+        // smoothed growth in bytes per ms
+        double rate = 0.0;
+        bool hasRate = false;
+    };
+
     QTimer *m_timer = nullptr;
-    QProcess *m_quotaProcess = nullptr;
+    QString m_quotaExecutable;
+    QElapsedTimer m_executablesChecked;
+    QuotaCollector *m_collector = nullptr;
+    QVector<QuotaParser::Quota> m_collectedQuotas;
+    int m_runningProcesses = 0;
+    int m_failedProcesses = 0;
+    // some file systems could only be queried with 'quota', which is not installed
+    bool m_missingQuotaTool = false;
+    QElapsedTimer m_clock;
+    QHash<QString, UsageTrend> m_trends;
     bool m_quotaInstalled = true;
     bool m_cleanUpToolInstalled = true;
     TrayStatus m_status = PassiveStatus;
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+#include "QuotaCollector.h"
+
+#include <QFile>
+#include <QSet>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/quota.h>
+#include <unistd.h>
+#endif
+
+QuotaCollector::QuotaCollector()
+{
+    setAutoDelete(false);
+}
+
+bool QuotaCollector::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+QVector<QuotaParser::Quota> QuotaCollector::quotas() const
+{
+    return m_quotas;
+}
+
+QStringList QuotaCollector::fallbackMountPoints() const
+{
+    return m_fallbackMountPoints;
+}
+
+bool QuotaCollector::hasMountTable() const
+{
+    return m_hasMountTable;
+}
+
+static bool isNetworkFileSystem(const QString &type)
+{
+    return type == QLatin1String("nfs") || type == QLatin1String("nfs4");
+}
+
+// file systems with quota support through the generic quotactl interface
+static bool isLocalQuotaFileSystem(const QString &type)
+{
+    return type.startsWith(QLatin1String("ext")) || type == QLatin1String("xfs") || type == QLatin1String("reiserfs") || type == QLatin1String("jfs")
+        || type == QLatin1String("gfs2") || type == QLatin1String("ocfs2") || type == QLatin1String("f2fs");
+}
+
+void QuotaCollector::run()
+{
+#ifdef Q_OS_LINUX
+    QFile file(QStringLiteral("/proc/self/mounts"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        Q_EMIT finished();
+        return;
+    }
+    // procfs files report no size, so read them in one go
+    const QVector<QuotaParser::Mount> mounts = QuotaParser::parseMounts(file.readAll());
+    m_hasMountTable = true;
+
+    // bind mounts show up once for each mount point, like 'quota' only report the first one
+    QSet<QString> seenDevices;
+    for (const QuotaParser::Mount &mount : mounts) {
+        if (seenDevices.contains(mount.device)) {
+            continue;
+        }
+        seenDevices.insert(mount.device);
+
+        if (isNetworkFileSystem(mount.type)) {
+            m_fallbackMountPoints.append(mount.mountPoint);
+            continue;
+        }
+        if (!isLocalQuotaFileSystem(mount.type) || !mount.device.startsWith(QLatin1Char('/'))) {
+            continue;
+        }
+
+        struct dqblk quota = {};
+        if (quotactl(QCMD(Q_GETQUOTA, USRQUOTA), QFile::encodeName(mount.device).constData(), getuid(), reinterpret_cast<caddr_t>(&quota)) != 0) {
+            // ESRCH: quota is not enabled on this file system
+            if (errno != ESRCH && errno != ENOENT) {
+                m_fallbackMountPoints.append(mount.mountPoint);
+            }
+            continue;
+        }
+
+        // like 'quota', skip file systems without any limits for the user
+        if (quota.dqb_bsoftlimit == 0 && quota.dqb_bhardlimit == 0) {
+            continue;
+        }
+
+        QuotaParser::Quota item;
+        item.mountPoint = mount.mountPoint;
+        item.used = qint64(quota.dqb_curspace);
+        item.softLimit = qint64(quota.dqb_bsoftlimit) * QIF_DQBLKSIZE;
+        item.hardLimit = qint64(quota.dqb_bhardlimit) * QIF_DQBLKSIZE;
+        m_quotas.append(item);
+    }
+#endif
+
+    Q_EMIT finished();
+}
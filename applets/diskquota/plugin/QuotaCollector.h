@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+#ifndef PLASMA_QUOTA_COLLECTOR_H
+#define PLASMA_QUOTA_COLLECTOR_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+
+#include "QuotaParser.h"
+
+/**
+ * Queries the quota of the local file systems on a worker thread.
+ *
+ * The quota of local block devices is read directly through quotactl(2).
+ * Mount points which can not be queried that way, like NFS shares, are
+ * collected in fallbackMountPoints() to be handled by the 'quota' tool.
+ */
+class QuotaCollector : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    QuotaCollector();
+
+    void run() override;
+
+    /**
+     * Whether quotactl(2) can be used on this system at all.
+     */
+    static bool isSupported();
+
+    /**
+     * The quotas found on local file systems, valid after finished().
+     */
+    QVector<QuotaParser::Quota> quotas() const;
+
+    /**
+     * The mount points to be queried with the 'quota' tool, valid after finished().
+     */
+    QStringList fallbackMountPoints() const;
+
+    /**
+     * Whether the mount table could be read. If not, all file systems have
+     * to be queried with the 'quota' tool, valid after finished().
+     */
+    bool hasMountTable() const;
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    QVector<QuotaParser::Quota> m_quotas;
+    QStringList m_fallbackMountPoints;
+    bool m_hasMountTable = false;
+};
+
+#endif // PLASMA_QUOTA_COLLECTOR_H
@@ -76,6 +76,16 @@ void QuotaItem::setFreeString(const QString &freeString)
     m_freeString = freeString;
 }
 
+QString QuotaItem::predictionString() const
+{
+    return m_predictionString;
+}
+
+void QuotaItem::setPredictionString(const QString &predictionString)
+{
+    m_predictionString = predictionString;
+}
+
 bool QuotaItem::operator==(const QuotaItem &other) const
 {
     // clang-format off
@@ -84,7 +94,8 @@ bool QuotaItem::operator==(const QuotaItem &other) const
         && m_usage == other.m_usage
         && m_mountString == other.m_mountString
         && m_usedString == other.m_usedString
-        && m_freeString == other.m_freeString;
+        && m_freeString == other.m_freeString
+        && m_predictionString == other.m_predictionString;
     // clang-format on
 }
 
@@ -35,6 +35,9 @@ public:
     QString freeString() const;
     void setFreeString(const QString &freeString);
 
+    QString predictionString() const;
+    void setPredictionString(const QString &predictionString);
+
     bool operator==(const QuotaItem &other) const;
     bool operator!=(const QuotaItem &other) const;
 
@@ -45,6 +48,7 @@ private:
     QString m_mountString;
     QString m_usedString;
     QString m_freeString;
+    QString m_predictionString;
 };
 
 Q_DECLARE_METATYPE(QuotaItem)
@@ -6,6 +6,7 @@
 #include "QuotaListModel.h"
 
 #include <QDebug>
+#include <QSet>
 
 QuotaListModel::QuotaListModel(QObject *parent)
     : QAbstractListModel(parent)
@@ -24,7 +25,38 @@ enum {
     UsedStringRole,
     MountPointRole,
     UsageRole,
+    PredictionStringRole,
 };
+
+/**
+ * Roles whose data differs between @p a and @p b.
+ */
+QVector<int> changedRoles(const QuotaItem &a, const QuotaItem &b)
+{
+    QVector<int> roles;
+    if (a.mountString() != b.mountString()) {
+        roles << DetailsRole;
+    }
+    if (a.iconName() != b.iconName()) {
+        roles << IconRole;
+    }
+    if (a.freeString() != b.freeString()) {
+        roles << FreeStringRole;
+    }
+    if (a.usedString() != b.usedString()) {
+        roles << UsedStringRole;
+    }
+    if (a.mountPoint() != b.mountPoint()) {
+        roles << MountPointRole;
+    }
+    if (a.usage() != b.usage()) {
+        roles << UsageRole;
+    }
+    if (a.predictionString() != b.predictionString()) {
+        roles << PredictionStringRole;
+    }
+    return roles;
+}
 }
 
 QHash<int, QByteArray> QuotaListModel::roleNames() const
@@ -36,6 +68,7 @@ QHash<int, QByteArray> QuotaListModel::roleNames() const
     roles[UsedStringRole] = "used";
     roles[MountPointRole] = "mountPoint";
     roles[UsageRole] = "usage";
+    roles[PredictionStringRole] = "prediction";
 
     return roles;
 }
@@ -46,7 +79,7 @@ QVariant QuotaListModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    const auto item = m_items[index.row()];
+    const QuotaItem &item = m_items[index.row()];
 
     switch (role) {
     case DetailsRole:
@@ -61,6 +94,8 @@ QVariant QuotaListModel::data(const QModelIndex &index, int role) const
         return item.mountPoint();
     case UsageRole:
         return item.usage();
+    case PredictionStringRole:
+        return item.predictionString();
     }
 
     return QVariant();
@@ -88,9 +123,10 @@ bool QuotaListModel::setData(const QModelIndex &index, const QVariant &variant,
         // is not the case, the newly inserted row must have an empty mountPoint().
         Q_ASSERT(item.mountPoint() == m_items[row].mountPoint() || m_items[row].mountPoint().isEmpty());
 
-        if (m_items[row] != item) {
+        const QVector<int> roles = changedRoles(m_items[row], item);
+        if (!roles.isEmpty()) {
             m_items[row] = item;
-            Q_EMIT dataChanged(index, index);
+            Q_EMIT dataChanged(index, index, roles);
             return true;
         }
     }
@@ -115,7 +151,7 @@ bool QuotaListModel::insertRows(int row, int count, const QModelIndex &parent)
 bool QuotaListModel::removeRows(int row, int count, const QModelIndex &parent)
 {
     // only top-level items are valid
-    if (parent.isValid() || (row + count) >= m_items.size()) {
+    if (parent.isValid() || row < 0 || count <= 0 || (row + count) > m_items.size()) {
         return false;
     }
 
@@ -135,18 +171,9 @@ void QuotaListModel::clear()
 
 namespace
 {
-QStringList mountPoints(const QVector<QuotaItem> &items)
-{
-    QStringList list;
-    for (auto &item : items) {
-        list.append(item.mountPoint());
-    }
-    return list;
-}
-
-int indexOfMountPoint(const QString &mountPoint, const QVector<QuotaItem> &items)
+int indexOfMountPoint(const QString &mountPoint, const QVector<QuotaItem> &items, int from = 0)
 {
-    for (int i = 0; i < items.size(); ++i) {
+    for (int i = from; i < items.size(); ++i) {
         if (mountPoint == items[i].mountPoint()) {
             return i;
         }
@@ -157,27 +184,44 @@ int indexOfMountPoint(const QString &mountPoint, const QVector<QuotaItem> &items
 
 void QuotaListModel::updateItems(const QVector<QuotaItem> &items)
 {
-    QStringList unusedMountPoints = mountPoints(m_items);
-
-    // merge existing and new mount points
-    for (auto &item : items) {
-        // remove still used item from unused list
-        unusedMountPoints.removeOne(item.mountPoint());
-
-        // insert or modify m_items
-        int row = indexOfMountPoint(item.mountPoint(), m_items);
-        if (row < 0) {
-            // new item: append on end
-            row = m_items.size();
-            insertRow(row);
+    QSet<QString> newMountPoints;
+    newMountPoints.reserve(items.size());
+    for (const QuotaItem &item : items) {
+        newMountPoints.insert(item.mountPoint());
+    }
+
+    // remove mount points that do not exist anymore, consecutive rows at once
+    for (int row = m_items.size() - 1; row >= 0;) {
+        if (newMountPoints.contains(m_items[row].mountPoint())) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !newMountPoints.contains(m_items[first - 1].mountPoint())) {
+            --first;
         }
-        setData(createIndex(row, 0), QVariant::fromValue(item));
+        removeRows(first, row - first + 1);
+        row = first - 1;
     }
 
-    // remove mount points, that do not exist anymore
-    for (const auto &mountPoint : unusedMountPoints) {
-        const int row = indexOfMountPoint(mountPoint, m_items);
-        Q_ASSERT(row >= 0);
-        removeRow(row);
+    // Now m_items holds a subset of items, bring it into the order of items.
+    // The order rarely changes, so usually each row only needs to be compared.
+    for (int row = 0; row < items.size(); ++row) {
+        const QuotaItem &item = items[row];
+        const int oldRow = indexOfMountPoint(item.mountPoint(), m_items, row);
+
+        if (oldRow < 0) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_items.insert(row, item);
+            endInsertRows();
+            continue;
+        }
+
+        if (oldRow != row) {
+            beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), row);
+            m_items.move(oldRow, row);
+            endMoveRows();
+        }
+        setData(index(row, 0), QVariant::fromValue(item));
     }
 }
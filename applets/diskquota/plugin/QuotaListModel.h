@@ -55,7 +55,8 @@ public: // QAbstractListModel overrides
 public: // additional helper functions
     /**
      * Merges @p items into the existing quota item list. Old items that are
-     * not available in @p items anymore are deleted.
+     * not available in @p items anymore are deleted. Only the rows and roles
+     * that actually changed are signaled, the model is never reset.
      */
     void updateItems(const QVector<QuotaItem> &items);
 
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+#include "QuotaParser.h"
+
+namespace QuotaParser
+{
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// decodes the octal escapes the kernel uses for blanks and backslashes in paths
+static QString decodeMountField(const char *begin, const char *end)
+{
+    QByteArray field;
+    field.reserve(end - begin);
+    for (const char *c = begin; c < end; ++c) {
+        if (*c == '\\' && end - c > 3 && c[1] >= '0' && c[1] <= '3' && c[2] >= '0' && c[2] <= '7' && c[3] >= '0' && c[3] <= '7') {
+            field.append(char(((c[1] - '0') << 6) | ((c[2] - '0') << 3) | (c[3] - '0')));
+            c += 3;
+        } else {
+            field.append(*c);
+        }
+    }
+    return QString::fromLocal8Bit(field);
+}
+
+QVector<Mount> parseMounts(const QByteArray &table)
+{
+    QVector<Mount> mounts;
+
+    const char *c = table.constData();
+    const char *const end = c + table.size();
+    while (c < end) {
+        const char *lineEnd = c;
+        while (lineEnd < end && *lineEnd != '\n') {
+            ++lineEnd;
+        }
+
+        // device, mount point and type are the first three fields, the rest is not needed
+        const char *fields[3][2];
+        int count = 0;
+        const char *p = c;
+        while (count < 3 && p < lineEnd) {
+            while (p < lineEnd && isBlank(*p)) {
+                ++p;
+            }
+            if (p == lineEnd || (count == 0 && *p == '#')) {
+                break;
+            }
+            fields[count][0] = p;
+            while (p < lineEnd && !isBlank(*p)) {
+                ++p;
+            }
+            fields[count][1] = p;
+            ++count;
+        }
+
+        if (count == 3) {
+            mounts.append({decodeMountField(fields[0][0], fields[0][1]),
+                           decodeMountField(fields[1][0], fields[1][1]),
+                           QString::fromLatin1(fields[2][0], fields[2][1] - fields[2][0])});
+        }
+
+        c = lineEnd + 1;
+    }
+
+    return mounts;
+}
+
+// returns the next blank separated token of @p line after @p pos, advancing @p pos
+static QStringView nextToken(QStringView line, int &pos)
+{
+    while (pos < line.size() && line[pos].isSpace()) {
+        ++pos;
+    }
+    const int start = pos;
+    while (pos < line.size() && !line[pos].isSpace()) {
+        ++pos;
+    }
+    return line.mid(start, pos - start);
+}
+
+// parses the leading digits of @p token, 'quota' prints plain decimal numbers
+static qint64 toNumber(QStringView token)
+{
+    qint64 number = 0;
+    for (const QChar c : token) {
+        if (c < QLatin1Char('0') || c > QLatin1Char('9')) {
+            break;
+        }
+        number = number * 10 + (c.unicode() - '0');
+    }
+    return number;
+}
+
+QVector<Quota> parseQuotaOutput(QStringView output)
+{
+    QVector<Quota> quotas;
+
+    // valid lines range from 7 to 9 parts (grace not always there):
+    // Disk quotas for user dh (uid 1000):
+    //      Filesystem   blocks  quota    limit     grace   files    quota   limit   grace
+    //       /home     16296500  50000000 60000000          389155       0       0
+    //       /home     16296500* 50000000 60000000      6   389155       0       0
+    //       /home     16296500* 50000000 60000000      4   389155       0       0       5
+    //       ^...........we want these...........^
+    // NOTE: In case of a soft limit violation, a '*' is added in the used blocks,
+    //       toNumber() stops there.
+    int lineStart = 0;
+    while (lineStart < output.size()) {
+        int lineEnd = lineStart;
+        while (lineEnd < output.size() && output[lineEnd] != QLatin1Char('\n') && output[lineEnd] != QLatin1Char('\r')) {
+            ++lineEnd;
+        }
+        const QStringView line = output.mid(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        // assumption: only the lines with a file system contain a slash
+        if (!line.contains(QLatin1Char('/'))) {
+            continue;
+        }
+
+        int pos = 0;
+        const QStringView mountPoint = nextToken(line, pos);
+        const QStringView used = nextToken(line, pos);
+        const QStringView softLimit = nextToken(line, pos);
+        const QStringView hardLimit = nextToken(line, pos);
+        if (hardLimit.isEmpty()) {
+            continue;
+        }
+
+        // 'quota' uses kilo bytes -> factor 1024
+        Quota quota;
+        quota.mountPoint = mountPoint.toString();
+        quota.used = toNumber(used) * 1024;
+        quota.softLimit = toNumber(softLimit) * 1024;
+        quota.hardLimit = toNumber(hardLimit) * 1024;
+        quotas.append(quota);
+    }
+
+    return quotas;
+}
+}
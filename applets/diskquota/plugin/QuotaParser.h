@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+#ifndef PLASMA_QUOTA_PARSER_H
+#define PLASMA_QUOTA_PARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+/**
+ * Parsers for the mount table and the output of the 'quota' tool.
+ * Both walk their input once without splitting it into lists first.
+ */
+namespace QuotaParser
+{
+/**
+ * One entry of the mount table.
+ */
+struct Mount {
+    QString device;
+    QString mountPoint;
+    QString type;
+};
+
+/**
+ * The quota of the current user on one mount point, all sizes in bytes.
+ */
+struct Quota {
+    QString mountPoint;
+    qint64 used = 0;
+    qint64 softLimit = 0;
+    qint64 hardLimit = 0;
+};
+
+/**
+ * Parses the contents of /proc/self/mounts or /etc/mtab.
+ * Escaped characters in the paths (e.g. '\040' for spaces) are decoded.
+ */
+QVector<Mount> parseMounts(const QByteArray &table);
+
+/**
+ * Parses the output of 'quota --show-mntpoint --hide-device --no-wrap'.
+ * The limits are given by 'quota' in KiB.
+ */
+QVector<Quota> parseQuotaOutput(QStringView output);
+}
+
+#endif // PLASMA_QUOTA_PARSER_H
@@ -8,80 +8,91 @@
 
 #include <QDebug>
 
+// larger images are reduced once after loading, scaling them for every board size is slow
+static const int MAX_SOURCE_SIZE = 2048;
+// bytes of scaled images kept, so resizing back and forth does not scale again
+static const int SCALED_CACHE_SIZE = 32 * 1024 * 1024;
+
 FifteenImageProvider::FifteenImageProvider()
-    : QQuickImageProvider(QQuickImageProvider::Pixmap)
-    , m_boardSize(4)
-    , m_pieceWidth(30)
-    , m_pieceHeight(30)
+    : QQuickImageProvider(QQuickImageProvider::Image)
 {
+    m_scaledImages.setMaxCost(SCALED_CACHE_SIZE);
 }
 
-QPixmap FifteenImageProvider::requestPixmap(const QString &id, QSize *size, const QSize &requestedSize)
+// keeps the scaled image alive as long as a piece refers to its pixels
+static void releaseScaledImage(void *image)
 {
-    Q_UNUSED(requestedSize); // wanted sizes are actually encoded in the id
+    delete static_cast<QImage *>(image);
+}
 
-    // id format is boardSize-imagenumber-pieceWidth-pieceHeight-imagePath
-    qDebug() << "pixmap requested with id " << id;
-    QStringList idParts = id.split(QLatin1Char('-'));
-    if (idParts.size() < 4) {
-        *size = QSize();
-        return QPixmap();
-    }
+QImage FifteenImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    Q_UNUSED(requestedSize); // wanted sizes are actually encoded in the id
 
-    bool update = false;
-    int boardSize = idParts.at(0).toInt();
-    int pieceWidth = idParts.at(2).toInt();
-    int pieceHeight = idParts.at(3).toInt();
-    QString path = idParts.at(4);
-    if (path != m_imagePath && !path.isEmpty()) {
-        m_imagePath = path;
-        qDebug() << "loading pixmap from file " << path << m_pixmap.load(path);
-        update = true;
+    // id format is boardSize-imagenumber-pieceWidth-pieceHeight-imagePath,
+    // the path may contain dashes itself
+    int separators[4];
+    int from = 0;
+    for (int &separator : separators) {
+        separator = id.indexOf(QLatin1Char('-'), from);
+        if (separator < 0) {
+            *size = QSize();
+            return QImage();
+        }
+        from = separator + 1;
     }
 
-    if (idParts.at(1) == QLatin1String("all")) {
-        return m_pixmap;
-    } else {
-        if (pieceWidth != m_pieceWidth || pieceHeight != m_pieceHeight) {
-            m_pieceWidth = pieceWidth;
-            m_pieceHeight = pieceHeight;
-            update = true;
+    const int boardSize = id.leftRef(separators[0]).toInt();
+    const QStringRef number = id.midRef(separators[0] + 1, separators[1] - separators[0] - 1);
+    const int pieceWidth = id.midRef(separators[1] + 1, separators[2] - separators[1] - 1).toInt();
+    const int pieceHeight = id.midRef(separators[2] + 1, separators[3] - separators[2] - 1).toInt();
+    const QStringRef path = id.midRef(separators[3] + 1);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (!path.isEmpty() && path != m_imagePath) {
+        m_imagePath = path.toString();
+        m_scaledImages.clear();
+        if (!m_image.load(m_imagePath)) {
+            qWarning() << "Could not load image" << m_imagePath;
+        } else if (m_image.width() > MAX_SOURCE_SIZE || m_image.height() > MAX_SOURCE_SIZE) {
+            m_image = m_image.scaled(MAX_SOURCE_SIZE, MAX_SOURCE_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         }
+    }
 
-        if (m_boardSize != boardSize) {
-            m_boardSize = boardSize;
-            update = true;
-        }
+    if (number == QLatin1String("all")) {
+        *size = m_image.size();
+        return m_image;
+    }
 
-        if (update) {
-            updatePixmaps();
-        }
+    const int piece = number.toInt();
+    if (m_image.isNull() || boardSize <= 0 || pieceWidth <= 0 || pieceHeight <= 0 || piece <= 0 || piece >= boardSize * boardSize) {
+        *size = QSize();
+        return QImage();
+    }
 
-        int number = idParts.at(1).toInt();
+    const QImage scaled = scaledImage(QSize(pieceWidth * boardSize, pieceHeight * boardSize));
 
-        qDebug() << "pixmap for piece " << number << " requested";
-        if (number > 0 && number < m_pixmaps.size()) {
-            *size = QSize(m_pieceWidth, m_pieceHeight);
-            return m_pixmaps.at(number);
-        }
-    }
+    // The piece refers to its part of the scaled image instead of copying it.
+    // QImage needs a non-const pointer here, but the pixels are never written
+    // through it: an image created on foreign data copies before modifying it.
+    const int x = (piece % boardSize) * pieceWidth;
+    const int y = (piece / boardSize) * pieceHeight;
+    uchar *pixels = const_cast<uchar *>(scaled.constScanLine(y)) + x * (scaled.depth() / 8);
 
-    *size = QSize();
-    return QPixmap();
+    *size = QSize(pieceWidth, pieceHeight);
+    return QImage(pixels, pieceWidth, pieceHeight, scaled.bytesPerLine(), scaled.format(), releaseScaledImage, new QImage(scaled));
 }
 
-void FifteenImageProvider::updatePixmaps()
+QImage FifteenImageProvider::scaledImage(const QSize &size)
 {
-    QSize size(m_pieceWidth * m_boardSize, m_pieceHeight * m_boardSize);
-    QPixmap copyPixmap = m_pixmap.scaled(size);
-
-    m_pixmaps.clear();
-    m_pixmaps.resize(m_boardSize * m_boardSize);
-
-    for (int i = 0; i < m_boardSize * m_boardSize; i++) {
-        int posX = (i % m_boardSize) * m_pieceWidth;
-        int posY = (i / m_boardSize) * m_pieceHeight;
-
-        m_pixmaps[i] = copyPixmap.copy(posX, posY, m_pieceWidth, m_pieceHeight);
+    const quint64 key = (quint64(size.width()) << 32) | quint32(size.height());
+    if (QImage *image = m_scaledImages.object(key)) {
+        return *image;
     }
+
+    // a format with whole bytes per pixel is needed to address the pieces
+    const QImage image = m_image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    m_scaledImages.insert(key, new QImage(image), int(image.sizeInBytes()));
+    return image;
 }
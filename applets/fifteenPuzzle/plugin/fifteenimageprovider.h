@@ -7,28 +7,28 @@
 #ifndef FIFTEENIMAGEPROVIDER_H
 #define FIFTEENIMAGEPROVIDER_H
 
+#include <QCache>
+#include <QImage>
+#include <QMutex>
 #include <QQuickImageProvider>
 #include <QString>
-#include <QVector>
 
 class FifteenImageProvider : public QQuickImageProvider
 {
 public:
     FifteenImageProvider();
 
-    QPixmap requestPixmap(const QString &id, QSize *size, const QSize &requestedSize) override;
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
 
 private:
-    // Update our pixmaps, called when sizes change or boardSize changes
-    void updatePixmaps();
+    // Returns the source scaled to the size of the whole board, cached per size
+    QImage scaledImage(const QSize &size);
 
+    QMutex m_mutex;
     QString m_imagePath;
-    QPixmap m_pixmap;
-    int m_boardSize;
-    int m_pieceWidth;
-    int m_pieceHeight;
-
-    QVector<QPixmap> m_pixmaps;
+    // the loaded image, reduced once if it is larger than any board will be
+    QImage m_image;
+    QCache<quint64, QImage> m_scaledImages;
 };
 
 #endif
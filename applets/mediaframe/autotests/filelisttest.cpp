@@ -0,0 +1,227 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "filelist.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTest>
+
+class FileListTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testAppend();
+    void testRemoveAt();
+    void testRemoveAtUnordered();
+    void testFilesBelow();
+    void testRandomOperations();
+    void benchmarkMemory();
+    void benchmarkIndexOf();
+};
+
+// a tree like the one of a photo collection, ordered by year and event
+static QString syntheticPath(int index)
+{
+    return QStringLiteral("/home/user/Pictures/%1/Event %2/IMG_%3.jpg").arg(2000 + index / 100000).arg(index / 1000).arg(index, 7, 10, QLatin1Char('0'));
+}
+
+// resident memory of the process in kB, -1 if unknown
+static qint64 residentMemory()
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+    return -1;
+}
+
+static void verifyList(const FileList &list, const QStringList &expected)
+{
+    QCOMPARE(list.count(), expected.count());
+    for (int i = 0; i < expected.count(); ++i) {
+        QCOMPARE(list.at(i), expected.at(i));
+        QCOMPARE(list.indexOf(expected.at(i)), i);
+    }
+}
+
+void FileListTest::testAppend()
+{
+    FileList list;
+    QVERIFY(list.isEmpty());
+    QCOMPARE(list.indexOf(QStringLiteral("/a/b.jpg")), -1);
+
+    const QStringList paths = {
+        QStringLiteral("/a/b.jpg"),
+        QStringLiteral("/a/c.jpg"),
+        QStringLiteral("/a/d/b.jpg"),
+        QStringLiteral("/ä/ö ü.png"),
+        QStringLiteral("/a/"),
+    };
+    for (const QString &path : paths) {
+        list.append(path);
+    }
+    QVERIFY(!list.isEmpty());
+    verifyList(list, paths);
+
+    QVERIFY(!list.contains(QStringLiteral("/a/e.jpg")));
+    QVERIFY(!list.contains(QStringLiteral("/unknown/b.jpg")));
+    QVERIFY(!list.contains(QStringLiteral("/a/b.jp")));
+
+    list.clear();
+    QVERIFY(list.isEmpty());
+    QVERIFY(!list.contains(paths.first()));
+}
+
+void FileListTest::testRemoveAt()
+{
+    FileList list;
+    QStringList expected;
+    for (int i = 0; i < 100; ++i) {
+        expected.append(syntheticPath(i * 37));
+        list.append(expected.last());
+    }
+
+    for (int index : {0, 50, 97, 10}) {
+        list.removeAt(index);
+        expected.removeAt(index);
+        verifyList(list, expected);
+    }
+    QVERIFY(!list.contains(syntheticPath(0)));
+}
+
+void FileListTest::testRemoveAtUnordered()
+{
+    FileList list;
+    for (int i = 0; i < 10; ++i) {
+        list.append(syntheticPath(i));
+    }
+
+    // the last file takes the place of the removed one
+    list.removeAtUnordered(3);
+    QCOMPARE(list.count(), 9);
+    QCOMPARE(list.at(3), syntheticPath(9));
+    QCOMPARE(list.indexOf(syntheticPath(9)), 3);
+    QCOMPARE(list.indexOf(syntheticPath(3)), -1);
+
+    list.removeAtUnordered(8);
+    QCOMPARE(list.count(), 8);
+    QCOMPARE(list.indexOf(syntheticPath(8)), -1);
+    QCOMPARE(list.indexOf(syntheticPath(7)), 7);
+}
+
+void FileListTest::testFilesBelow()
+{
+    FileList list;
+    list.append(QStringLiteral("/photos/a.jpg"));
+    list.append(QStringLiteral("/photos/trip/b.jpg"));
+    list.append(QStringLiteral("/photos/trip/day 1/c.jpg"));
+    list.append(QStringLiteral("/photos/trips/d.jpg"));
+
+    const QStringList expected = {QStringLiteral("/photos/trip/b.jpg"), QStringLiteral("/photos/trip/day 1/c.jpg")};
+    QCOMPARE(list.filesBelow(QStringLiteral("/photos/trip")), expected);
+    QCOMPARE(list.filesBelow(QStringLiteral("/videos")), QStringList());
+
+    QCOMPARE(list.filesIn(QStringLiteral("/photos/trip")), QStringList{QStringLiteral("/photos/trip/b.jpg")});
+    QCOMPARE(list.filesIn(QStringLiteral("/videos")), QStringList());
+}
+
+void FileListTest::testRandomOperations()
+{
+    // with thousands of files in the hash table probe sequences wrap around its
+    // end, removing from them has to keep every file reachable
+    QRandomGenerator random(42);
+    FileList list;
+    QStringList expected;
+    int next = 0;
+
+    for (int round = 0; round < 20000; ++round) {
+        // the list slowly grows, which rehashes it from time to time
+        const int operation = random.bounded(10);
+        if (operation < 6 || expected.isEmpty()) {
+            expected.append(syntheticPath(next++));
+            list.append(expected.last());
+        } else {
+            const int index = random.bounded(expected.count());
+            if (operation < 8) {
+                list.removeAt(index);
+                expected.removeAt(index);
+            } else {
+                list.removeAtUnordered(index);
+                expected[index] = expected.last();
+                expected.removeLast();
+            }
+        }
+
+        if (round % 1000 == 0) {
+            verifyList(list, expected);
+        }
+    }
+    verifyList(list, expected);
+
+    // removing most files compacts the names
+    while (expected.count() > 10) {
+        list.removeAtUnordered(0);
+        expected[0] = expected.last();
+        expected.removeLast();
+    }
+    verifyList(list, expected);
+}
+
+void FileListTest::benchmarkMemory()
+{
+    const int count = 1000000;
+    if (residentMemory() < 0) {
+        QSKIP("The memory usage is not known on this system");
+    }
+
+    qint64 before = residentMemory();
+    FileList list;
+    for (int i = 0; i < count; ++i) {
+        list.append(syntheticPath(i));
+    }
+    const qint64 listMemory = residentMemory() - before;
+
+    before = residentMemory();
+    QStringList paths;
+    for (int i = 0; i < count; ++i) {
+        paths.append(syntheticPath(i));
+    }
+    const qint64 stringListMemory = residentMemory() - before;
+
+    qDebug() << "1M files take" << listMemory << "kB, as a QStringList" << stringListMemory << "kB";
+    QCOMPARE(list.count(), paths.count());
+    QVERIFY(listMemory < stringListMemory / 2);
+}
+
+void FileListTest::benchmarkIndexOf()
+{
+    FileList list;
+    for (int i = 0; i < 100000; ++i) {
+        list.append(syntheticPath(i));
+    }
+
+    QStringList lookups;
+    for (int i = 0; i < 1000; ++i) {
+        lookups.append(syntheticPath(i * 100 + 7));
+    }
+
+    QBENCHMARK {
+        for (const QString &path : qAsConst(lookups)) {
+            QVERIFY(list.indexOf(path) >= 0);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(FileListTest)
+
+#include "filelisttest.moc"
@@ -0,0 +1,98 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "shuffleorder.h"
+
+#include <QSet>
+#include <QTest>
+#include <QVector>
+
+class ShuffleOrderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testPermutation_data();
+    void testPermutation();
+    void testGrow();
+    void testRandomKeys();
+};
+
+static QVector<quint32> cycle(ShuffleOrder &order)
+{
+    QVector<quint32> indices;
+    while (!order.atEnd()) {
+        indices.append(order.next());
+    }
+    return indices;
+}
+
+void ShuffleOrderTest::testPermutation_data()
+{
+    QTest::addColumn<quint32>("size");
+
+    QTest::newRow("one") << 1u;
+    QTest::newRow("two") << 2u;
+    QTest::newRow("power of two") << 1024u;
+    QTest::newRow("odd") << 1001u;
+}
+
+void ShuffleOrderTest::testPermutation()
+{
+    QFETCH(quint32, size);
+
+    ShuffleOrder order;
+    order.reset(size);
+    QCOMPARE(order.size(), size);
+
+    const QVector<quint32> indices = cycle(order);
+    QCOMPARE(quint32(indices.count()), size);
+    QSet<quint32> seen;
+    for (quint32 index : indices) {
+        QVERIFY(index < size);
+        seen.insert(index);
+    }
+    QCOMPARE(quint32(seen.count()), size);
+}
+
+void ShuffleOrderTest::testGrow()
+{
+    // growing an empty order starts the first cycle, like the first batch of found files does
+    ShuffleOrder order;
+    order.grow(100);
+
+    QSet<quint32> seen;
+    for (int i = 0; i < 60; ++i) {
+        seen.insert(order.next());
+    }
+
+    order.grow(1000);
+    QCOMPARE(order.size(), 1000u);
+    const QVector<quint32> rest = cycle(order);
+    QCOMPARE(rest.count(), 940);
+    for (quint32 index : rest) {
+        QVERIFY2(!seen.contains(index), "an index visited before growing came again");
+        seen.insert(index);
+    }
+    QCOMPARE(seen.count(), 1000);
+}
+
+void ShuffleOrderTest::testRandomKeys()
+{
+    // every session starts with a different order, also when the first cycle grew from nothing
+    ShuffleOrder first;
+    ShuffleOrder second;
+    first.grow(1000);
+    second.grow(1000);
+    QVERIFY(cycle(first) != cycle(second));
+
+    first.reset(1000);
+    second.reset(1000);
+    QVERIFY(cycle(first) != cycle(second));
+}
+
+QTEST_GUILESS_MAIN(ShuffleOrderTest)
+
+#include "shuffleordertest.moc"
@@ -9,6 +9,7 @@ import QtQuick.Layouts 1.1
 import QtQuick.Dialogs 1.2
 import QtQuick.Controls 1.3
 import QtQuick.Controls.Styles 1.2
+import QtQuick.Window 2.2
 
 import org.kde.draganddrop 2.0 as DragDrop
 
@@ -25,6 +26,8 @@ Item {
     MediaFrame {
         id: items
         random: plasmoid.configuration.randomize
+        preloadSize: Qt.size(frontImage.sourceSize.width * Screen.devicePixelRatio,
+                             frontImage.sourceSize.height * Screen.devicePixelRatio)
     }
 
     Plasmoid.preferredRepresentation: plasmoid.fullRepresentation
@@ -192,7 +195,7 @@ Item {
                 opacity: 0
 
                 cache: false
-                source: transitionSource
+                source: items.imageUrl(transitionSource)
 
                 asynchronous: true
                 autoTransform: true
@@ -205,7 +208,7 @@ Item {
                 fillMode: plasmoid.configuration.fillMode
 
                 cache: false
-                source: activeSource
+                source: items.imageUrl(activeSource)
 
                 asynchronous: true
                 autoTransform: true
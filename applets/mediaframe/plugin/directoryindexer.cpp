@@ -0,0 +1,167 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "directoryindexer.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+// batches are reported once they are this large or this many ms old,
+// whatever comes first, to not flood QML with count changes
+static const int BATCH_SIZE = 1000;
+static const int BATCH_INTERVAL = 250;
+
+static const quint32 INDEX_VERSION = 1;
+
+DirectoryIndexer::DirectoryIndexer(const QString &path, const QStringList &filters, bool recursive)
+    : m_path(QDir::cleanPath(path))
+    , m_filters(filters)
+    , m_recursive(recursive)
+{
+    setAutoDelete(false);
+}
+
+void DirectoryIndexer::setPersistent(bool persistent)
+{
+    m_persistent = persistent;
+}
+
+void DirectoryIndexer::cancel()
+{
+    m_cancelled.storeRelaxed(1);
+}
+
+QString DirectoryIndexer::indexPath() const
+{
+    const QString key = m_path + (m_recursive ? QLatin1String(":recursive") : QLatin1String(":flat"));
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/plasma_mediaframe/index/")
+        + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+QHash<QString, DirectoryIndexer::Directory> DirectoryIndexer::loadIndex() const
+{
+    QHash<QString, Directory> index;
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return index;
+    }
+
+    QDataStream stream(&file);
+    quint32 version;
+    QStringList filters;
+    stream >> version >> filters;
+    // a changed set of image formats invalidates all file lists
+    if (version != INDEX_VERSION || filters != m_filters) {
+        return index;
+    }
+
+    quint32 count;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Directory directory;
+        stream >> path >> directory.lastModified >> directory.files >> directory.subdirectories;
+        index.insert(path, directory);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring corrupt index" << file.fileName();
+        index.clear();
+    }
+    return index;
+}
+
+void DirectoryIndexer::saveIndex(const QHash<QString, Directory> &index) const
+{
+    QDir().mkpath(QFileInfo(indexPath()).absolutePath());
+
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write index" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << INDEX_VERSION << m_filters << quint32(index.count());
+    for (auto it = index.cbegin(), end = index.cend(); it != end; ++it) {
+        stream << it.key() << it->lastModified << it->files << it->subdirectories;
+    }
+    file.commit();
+}
+
+void DirectoryIndexer::run()
+{
+    const QHash<QString, Directory> oldIndex = m_persistent ? loadIndex() : QHash<QString, Directory>();
+    QHash<QString, Directory> index;
+    QSet<QString> visited;
+    QStringList pending{m_path};
+
+    QStringList batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    int listed = 0;
+    while (!pending.isEmpty() && !m_cancelled.loadRelaxed()) {
+        const QString path = pending.takeLast();
+
+        const QFileInfo info(path);
+        // symlinks are followed, make sure loops are only walked once
+        if (m_recursive) {
+            const QString canonicalPath = info.canonicalFilePath();
+            if (visited.contains(canonicalPath)) {
+                continue;
+            }
+            visited.insert(canonicalPath);
+        }
+
+        const qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+        Directory directory = oldIndex.value(path);
+        if (directory.lastModified != lastModified || lastModified == 0) {
+            const QDir dir(path);
+            directory.lastModified = lastModified;
+            directory.files = dir.entryList(m_filters, QDir::Files, QDir::NoSort);
+            if (m_recursive) {
+                directory.subdirectories = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::NoSort);
+            }
+            ++listed;
+        }
+
+        for (const QString &file : qAsConst(directory.files)) {
+            batch.append(path + QLatin1Char('/') + file);
+        }
+        for (const QString &subdirectory : qAsConst(directory.subdirectories)) {
+            pending.append(path + QLatin1Char('/') + subdirectory);
+        }
+        index.insert(path, directory);
+
+        if (batch.count() >= BATCH_SIZE || (!batch.isEmpty() && batchTimer.hasExpired(BATCH_INTERVAL))) {
+            Q_EMIT filesFound(batch);
+            batch.clear();
+            batchTimer.restart();
+        }
+    }
+
+    if (!m_cancelled.loadRelaxed()) {
+        if (!batch.isEmpty()) {
+            Q_EMIT filesFound(batch);
+        }
+        qDebug() << "Indexed" << m_path << "listing" << listed << "of" << index.count() << "directories";
+        if (m_persistent) {
+            saveIndex(index);
+        }
+    }
+
+    Q_EMIT finished();
+}
@@ -0,0 +1,64 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef DIRECTORYINDEXER_H
+#define DIRECTORYINDEXER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+
+/**
+ * Collects the images below a directory on a worker thread.
+ *
+ * The files are reported in batches while the directory tree is walked. The
+ * resulting index is kept in the cache, on the next run only directories whose
+ * modification time changed are listed again.
+ */
+class DirectoryIndexer : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    DirectoryIndexer(const QString &path, const QStringList &filters, bool recursive);
+
+    void run() override;
+
+    /**
+     * Sets whether the index is kept in the cache for the next run, the default is true.
+     */
+    void setPersistent(bool persistent);
+
+    /**
+     * Stops indexing as soon as possible, no further batches are reported then.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    void filesFound(const QStringList &files);
+    void finished();
+
+private:
+    struct Directory {
+        qint64 lastModified = 0;
+        QStringList files;
+        QStringList subdirectories;
+    };
+
+    QString indexPath() const;
+    QHash<QString, Directory> loadIndex() const;
+    void saveIndex(const QHash<QString, Directory> &index) const;
+
+    const QString m_path;
+    const QStringList m_filters;
+    const bool m_recursive;
+    bool m_persistent = true;
+    QAtomicInt m_cancelled;
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "filelist.h"
+
+#include <cstring>
+
+static const int MIN_BUCKETS = 64;
+
+void FileList::split(const QString &path, QString *dir, QByteArray *name)
+{
+    const int slash = path.lastIndexOf(QLatin1Char('/'));
+    *dir = path.left(slash + 1);
+    *name = path.midRef(slash + 1).toUtf8();
+}
+
+QString FileList::at(int index) const
+{
+    const Entry &entry = m_entries.at(index);
+    return m_dirs.at(entry.dir) + QString::fromUtf8(m_names.constData() + entry.offset, entry.length);
+}
+
+bool FileList::matches(const Entry &entry, int dir, const QByteArray &name) const
+{
+    return int(entry.dir) == dir && int(entry.length) == name.size() && std::memcmp(m_names.constData() + entry.offset, name.constData(), name.size()) == 0;
+}
+
+int FileList::indexOf(const QString &path) const
+{
+    if (m_entries.isEmpty()) {
+        return -1;
+    }
+
+    QString dirPath;
+    QByteArray name;
+    split(path, &dirPath, &name);
+
+    const int dir = m_dirIndex.value(dirPath, -1);
+    if (dir < 0) {
+        return -1;
+    }
+
+    const int mask = m_buckets.count() - 1;
+    const uint hash = qHashBits(name.constData(), name.size(), dir);
+    for (int bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+        const int index = m_buckets.at(bucket);
+        if (index < 0) {
+            return -1;
+        }
+        const Entry &entry = m_entries.at(index);
+        if (entry.hash == hash && matches(entry, dir, name)) {
+            return index;
+        }
+    }
+}
+
+void FileList::append(const QString &path)
+{
+    QString dirPath;
+    QByteArray name;
+    split(path, &dirPath, &name);
+
+    auto it = m_dirIndex.constFind(dirPath);
+    if (it == m_dirIndex.constEnd()) {
+        it = m_dirIndex.insert(dirPath, m_dirs.count());
+        m_dirs.append(dirPath);
+    }
+
+    Entry entry;
+    entry.dir = it.value();
+    entry.offset = m_names.size();
+    entry.length = name.size();
+    entry.hash = qHashBits(name.constData(), name.size(), entry.dir);
+    m_names.append(name);
+    m_entries.append(entry);
+
+    // keep the table at most half full, the probe sequences stay short then
+    if (m_entries.count() * 2 > m_buckets.count()) {
+        rehash(qMax(MIN_BUCKETS, m_buckets.count() * 2));
+    } else {
+        insertBucket(m_entries.count() - 1);
+    }
+}
+
+void FileList::removeAt(int index)
+{
+    removeBucket(findBucket(index));
+    m_unusedNames += m_entries.at(index).length;
+    m_entries.remove(index);
+
+    for (int &bucket : m_buckets) {
+        if (bucket > index) {
+            --bucket;
+        }
+    }
+
+    compactIfWasteful();
+}
+
+void FileList::removeAtUnordered(int index)
+{
+    removeBucket(findBucket(index));
+    m_unusedNames += m_entries.at(index).length;
+
+    const int last = m_entries.count() - 1;
+    if (index != last) {
+        m_buckets[findBucket(last)] = index;
+        m_entries[index] = m_entries.at(last);
+    }
+    m_entries.removeLast();
+
+    compactIfWasteful();
+}
+
+void FileList::compactIfWasteful()
+{
+    // removed names stay in the buffer until enough of it is unused
+    if (m_unusedNames > 4096 && m_unusedNames > m_names.size() / 2) {
+        compact();
+    }
+}
+
+QStringList FileList::filesBelow(const QString &directory) const
+{
+    const QString prefix = directory + QLatin1Char('/');
+
+    // only the few directories are compared, not every path
+    QVector<bool> below(m_dirs.count());
+    bool any = false;
+    for (int i = 0; i < m_dirs.count(); ++i) {
+        below[i] = m_dirs.at(i).startsWith(prefix);
+        any = any || below.at(i);
+    }
+
+    QStringList files;
+    if (any) {
+        for (int i = 0; i < m_entries.count(); ++i) {
+            if (below.at(m_entries.at(i).dir)) {
+                files.append(at(i));
+            }
+        }
+    }
+    return files;
+}
+
+QStringList FileList::filesIn(const QString &directory) const
+{
+    QStringList files;
+    const int dir = m_dirIndex.value(directory + QLatin1Char('/'), -1);
+    if (dir >= 0) {
+        for (int i = 0; i < m_entries.count(); ++i) {
+            if (int(m_entries.at(i).dir) == dir) {
+                files.append(at(i));
+            }
+        }
+    }
+    return files;
+}
+
+void FileList::clear()
+{
+    m_dirs.clear();
+    m_dirIndex.clear();
+    m_names.clear();
+    m_unusedNames = 0;
+    m_entries.clear();
+    m_buckets.clear();
+}
+
+int FileList::findBucket(int index) const
+{
+    const int mask = m_buckets.count() - 1;
+    int bucket = m_entries.at(index).hash & mask;
+    while (m_buckets.at(bucket) != index) {
+        bucket = (bucket + 1) & mask;
+    }
+    return bucket;
+}
+
+void FileList::insertBucket(int index)
+{
+    const int mask = m_buckets.count() - 1;
+    int bucket = m_entries.at(index).hash & mask;
+    while (m_buckets.at(bucket) >= 0) {
+        bucket = (bucket + 1) & mask;
+    }
+    m_buckets[bucket] = index;
+}
+
+void FileList::removeBucket(int bucket)
+{
+    // shift the following entries of the probe sequence back instead of leaving
+    // a tombstone, so lookups never have to skip deleted buckets
+    const int mask = m_buckets.count() - 1;
+    int next = bucket;
+    while (true) {
+        next = (next + 1) & mask;
+        const int index = m_buckets.at(next);
+        if (index < 0) {
+            break;
+        }
+        const int home = m_entries.at(index).hash & mask;
+        const bool inPlace = bucket <= next ? (bucket < home && home <= next) : (bucket < home || home <= next);
+        if (!inPlace) {
+            m_buckets[bucket] = index;
+            bucket = next;
+        }
+    }
+    m_buckets[bucket] = -1;
+}
+
+void FileList::rehash(int capacity)
+{
+    m_buckets.fill(-1, capacity);
+    for (int i = 0; i < m_entries.count(); ++i) {
+        insertBucket(i);
+    }
+}
+
+void FileList::compact()
+{
+    QByteArray names;
+    names.reserve(m_names.size() - m_unusedNames);
+    for (Entry &entry : m_entries) {
+        const quint32 offset = names.size();
+        names.append(m_names.constData() + entry.offset, entry.length);
+        entry.offset = offset;
+    }
+    m_names = names;
+    m_unusedNames = 0;
+}
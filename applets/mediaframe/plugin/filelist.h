@@ -0,0 +1,105 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef FILELIST_H
+#define FILELIST_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * A list of file paths with compact storage for large collections.
+ *
+ * The directories are stored once each. For every file only the index of
+ * its directory and its name are kept, as UTF-8 in a shared buffer. Full paths
+ * are built on access. The position of a path can be looked up in constant
+ * time without a second copy of the path.
+ */
+class FileList
+{
+public:
+    int count() const
+    {
+        return m_entries.count();
+    }
+
+    bool isEmpty() const
+    {
+        return m_entries.isEmpty();
+    }
+
+    QString at(int index) const;
+
+    /**
+     * Returns the position of @p path, or -1 if it is not in the list.
+     */
+    int indexOf(const QString &path) const;
+
+    bool contains(const QString &path) const
+    {
+        return indexOf(path) >= 0;
+    }
+
+    /**
+     * Appends @p path, which must not be in the list yet.
+     */
+    void append(const QString &path);
+
+    /**
+     * Removes the file at @p index, the following files move up by one.
+     * This takes linear time.
+     */
+    void removeAt(int index);
+
+    /**
+     * Removes the file at @p index by moving the last file into its place.
+     * This takes constant time but changes the order.
+     */
+    void removeAtUnordered(int index);
+
+    /**
+     * Returns the files inside @p directory and its subdirectories.
+     */
+    QStringList filesBelow(const QString &directory) const;
+
+    /**
+     * Returns the files directly inside @p directory.
+     */
+    QStringList filesIn(const QString &directory) const;
+
+    void clear();
+
+private:
+    struct Entry {
+        quint32 dir;
+        quint32 offset;
+        quint32 length;
+        uint hash;
+    };
+
+    static void split(const QString &path, QString *dir, QByteArray *name);
+    bool matches(const Entry &entry, int dir, const QByteArray &name) const;
+    int findBucket(int index) const;
+    void insertBucket(int index);
+    void removeBucket(int bucket);
+    void compactIfWasteful();
+    void rehash(int capacity);
+    void compact();
+
+    // directories including the trailing slash
+    QStringList m_dirs;
+    QHash<QString, int> m_dirIndex;
+    QByteArray m_names;
+    int m_unusedNames = 0;
+    QVector<Entry> m_entries;
+    // open addressing table of entry indices with linear probing, -1 marks a free bucket
+    QVector<int> m_buckets;
+};
+
+#endif
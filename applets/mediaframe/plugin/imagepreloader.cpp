@@ -0,0 +1,130 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "imagepreloader.h"
+#include "renditioncache.h"
+
+#include <QImageReader>
+#include <QThreadPool>
+
+// memory in KiB the preloaded images may take
+static const int MEMORY_BUDGET = 64 * 1024;
+
+Q_GLOBAL_STATIC(ImagePreloader, s_preloader)
+
+PreloadImageThread::PreloadImageThread(const QString &file, const QSize &size)
+    : m_file(file)
+    , m_size(size)
+{
+}
+
+void PreloadImageThread::run()
+{
+    QSize nativeSize;
+    const QImage image = ImagePreloader::decode(m_file, m_size, &nativeSize);
+    ImagePreloader::self()->insert(m_file, image, nativeSize);
+}
+
+ImagePreloader::ImagePreloader()
+    : m_images(MEMORY_BUDGET)
+{
+}
+
+ImagePreloader *ImagePreloader::self()
+{
+    return s_preloader();
+}
+
+void ImagePreloader::preload(const QString &file, const QSize &size)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_loading.contains(file)) {
+            return;
+        }
+        const Entry *entry = m_images.object(file);
+        if (entry && entry->covers(size)) {
+            return;
+        }
+        m_loading.insert(file);
+    }
+
+    QThreadPool::globalInstance()->start(new PreloadImageThread(file, size));
+}
+
+QImage ImagePreloader::image(const QString &file, const QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+    // kept in the cache, both images of the fade transition show the same file in turn
+    const Entry *entry = m_images.object(file);
+    if (!entry || !entry->covers(size)) {
+        return QImage();
+    }
+    return entry->image;
+}
+
+bool ImagePreloader::Entry::covers(const QSize &size) const
+{
+    // images smaller than the requested size are shown at their native size
+    const QSize neededSize = size.boundedTo(nativeSize);
+    return image.width() >= neededSize.width() && image.height() >= neededSize.height();
+}
+
+void ImagePreloader::insert(const QString &file, const QImage &image, const QSize &nativeSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_loading.remove(file);
+    if (!image.isNull()) {
+        m_images.insert(file, new Entry{image, nativeSize.isValid() ? nativeSize : image.size()}, qMax(1, int(image.sizeInBytes() / 1024)));
+    }
+}
+
+QImage ImagePreloader::decode(const QString &file, const QSize &size, QSize *nativeSize)
+{
+    QImageReader reader(file);
+    reader.setAutoTransform(true);
+
+    QSize imageSize = reader.size();
+    if (!imageSize.isValid() || !size.isValid() || size.isEmpty()) {
+        const QImage image = reader.read();
+        if (nativeSize) {
+            *nativeSize = image.size();
+        }
+        return image;
+    }
+
+    // the reader scales before it rotates, so compare in the rotated orientation
+    const bool transposed = reader.transformation() & QImageIOHandler::TransformationRotate90;
+    if (transposed) {
+        imageSize.transpose();
+    }
+    if (nativeSize) {
+        *nativeSize = imageSize;
+    }
+
+    const int renditionSize = RenditionCache::renditionSize(imageSize, size);
+    // never scale up, the view does that on its own
+    if (renditionSize >= qMax(imageSize.width(), imageSize.height())) {
+        return reader.read();
+    }
+
+    const QFileInfo info(file);
+    QImage image = RenditionCache::load(info, renditionSize);
+    if (!image.isNull()) {
+        return image;
+    }
+
+    QSize scaledSize = imageSize.scaled(renditionSize, renditionSize, Qt::KeepAspectRatio);
+    if (transposed) {
+        scaledSize.transpose();
+    }
+    reader.setScaledSize(scaledSize);
+    image = reader.read();
+    if (!image.isNull()) {
+        RenditionCache::store(info, renditionSize, image);
+    }
+    return image;
+}
@@ -0,0 +1,80 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef IMAGEPRELOADER_H
+#define IMAGEPRELOADER_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+#include <QSize>
+
+/**
+ * Decodes the upcoming images of the slideshow on a worker thread,
+ * already scaled down to the size they are shown at.
+ *
+ * The decoded images are kept within a fixed memory budget until the
+ * image provider asks for them.
+ */
+class ImagePreloader
+{
+public:
+    ImagePreloader();
+
+    static ImagePreloader *self();
+
+    /**
+     * Starts decoding the local image @p file for showing it at @p size in the background.
+     */
+    void preload(const QString &file, const QSize &size);
+
+    /**
+     * Returns the preloaded image of @p file if it is large enough for @p size,
+     * a null image otherwise.
+     */
+    QImage image(const QString &file, const QSize &size);
+
+    /**
+     * Decodes @p file scaled down to cover @p size, applying the EXIF orientation.
+     * Downscaled copies are taken from and added to the RenditionCache.
+     *
+     * If @p nativeSize is given, it is set to the size of the full image.
+     */
+    static QImage decode(const QString &file, const QSize &size, QSize *nativeSize = nullptr);
+
+private:
+    friend class PreloadImageThread;
+
+    struct Entry {
+        QImage image;
+        // the image is never scaled up, it is only compared against sizes up to this one
+        QSize nativeSize;
+
+        bool covers(const QSize &size) const;
+    };
+
+    void insert(const QString &file, const QImage &image, const QSize &nativeSize);
+
+    QMutex m_mutex;
+    QCache<QString, Entry> m_images;
+    QSet<QString> m_loading;
+};
+
+class PreloadImageThread : public QRunnable
+{
+public:
+    PreloadImageThread(const QString &file, const QSize &size);
+    void run() override;
+
+private:
+    QString m_file;
+    QSize m_size;
+};
+
+#endif
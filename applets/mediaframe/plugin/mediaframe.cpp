@@ -5,21 +5,35 @@
  */
 
 #include "mediaframe.h"
+#include "directoryindexer.h"
+#include "imagepreloader.h"
 
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QImageReader>
 #include <QMimeDatabase>
-#include <QRandomGenerator>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QStandardPaths>
+#include <QThreadPool>
 #include <QTime>
 #include <QUrl>
 
 #include <KIO/StoredTransferJob>
 
+// number of images decoded ahead of time
+static const int LOOKAHEAD = 2;
+// number of remote images downloaded at the same time
+static const int MAX_FETCHES = 3;
+// cached remote images older than this many seconds are checked for changes
+static const int REVALIDATE_AFTER = 24 * 60 * 60;
+
 MediaFrame::MediaFrame(QObject *parent)
     : QObject(parent)
 {
@@ -35,9 +49,16 @@ MediaFrame::MediaFrame(QObject *parent)
 
     connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &MediaFrame::slotItemChanged);
     connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &MediaFrame::slotItemChanged);
+
+    connect(&m_dirWatch, &KDirWatch::dirty, this, &MediaFrame::slotDirty);
+    connect(&m_dirWatch, &KDirWatch::created, this, &MediaFrame::slotCreated);
+    connect(&m_dirWatch, &KDirWatch::deleted, this, &MediaFrame::slotDeleted);
 }
 
-MediaFrame::~MediaFrame() = default;
+MediaFrame::~MediaFrame()
+{
+    cancelIndexing();
+}
 
 int MediaFrame::count() const
 {
@@ -53,25 +74,29 @@ void MediaFrame::setRandom(bool random)
 {
     if (random != m_random) {
         m_random = random;
+        m_upcoming.clear();
         Q_EMIT randomChanged();
     }
 }
 
-int MediaFrame::random(int min, int max)
+QSize MediaFrame::preloadSize() const
 {
-    if (min > max) {
-        int temp = min;
-        min = max;
-        max = temp;
-    }
+    return m_preloadSize;
+}
 
-    // qDebug() << "random" << min << "<->" << max << "=" << ((qrand()%(max-min+1))+min);
-    return (QRandomGenerator::global()->bounded((max - min + 1)) + min);
+void MediaFrame::setPreloadSize(const QSize &size)
+{
+    if (size != m_preloadSize) {
+        m_preloadSize = size;
+        Q_EMIT preloadSizeChanged();
+    }
 }
 
 QString MediaFrame::getCacheDirectory()
 {
-    return QDir::temp().absolutePath();
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/plasma_mediaframe/remote");
+    QDir().mkpath(path);
+    return path;
 }
 
 QString MediaFrame::hash(const QString &str)
@@ -111,63 +136,240 @@ void MediaFrame::add(const QString &path, AddOption option)
     QString localPath = url.toString(QUrl::PreferLocalFile);
     // qDebug() << "Local path" << localPath << "Path" << path;
 
-    QStringList paths;
-    QString filePath;
-
     if (isDir(localPath)) {
-        if (!isDirEmpty(localPath)) {
-            QDirIterator dirIterator(
-                localPath,
-                m_filters,
-                QDir::Files,
-                (option == AddOption::RECURSIVE ? QDirIterator::Subdirectories | QDirIterator::FollowSymlinks : QDirIterator::NoIteratorFlags));
-
-            while (dirIterator.hasNext()) {
-                dirIterator.next();
-
-                filePath = dirIterator.filePath();
-                paths.append(filePath);
-                m_allFiles.append(filePath);
-                // qDebug() << "Appended" << filePath;
-                Q_EMIT countChanged();
-            }
-            if (paths.count() > 0) {
-                m_pathMap.insert(path, paths);
-                qDebug() << "Added" << paths.count() << "files from" << path;
+        // large collections take a while to walk, so this happens in the background
+        // and the files are added in batches while they are found
+        m_pathMap.insert(path, 0);
+
+        const bool recursive = option == AddOption::RECURSIVE;
+        DirectoryIndexer *indexer = startIndexing(path, localPath, recursive);
+        connect(indexer, &DirectoryIndexer::finished, this, [this, path]() {
+            const int count = m_pathMap.value(path);
+            if (count > 0) {
+                qDebug() << "Added" << count << "files from" << path;
             } else {
+                // still watched, images added later on show up
                 qWarning() << "No images found in directory" << path;
             }
-        } else {
-            qWarning() << "Not adding empty directory" << path;
-        }
-
-        // the pictures have to be sorted before adding them to the list,
-        // because the QDirIterator sorts them in a different way than QDir::entryList
-        // paths.sort();
+        });
 
+        // new and removed images are picked up without walking the directory again. Only the
+        // directories are watched, a watch for each file would list the whole tree right away
+        // and could use up the inotify watches of the session.
+        m_watchedDirs.insert(QDir::cleanPath(localPath), WatchedDir{path, recursive});
+        m_dirWatch.addDir(localPath, recursive ? KDirWatch::WatchSubDirs : KDirWatch::WatchDirOnly);
     } else if (isFile(localPath)) {
-        paths.append(path);
-        m_pathMap.insert(path, paths);
-        m_allFiles.append(path);
-        qDebug() << "Added" << paths.count() << "files from" << path;
-        Q_EMIT countChanged();
+        addFiles(path, {path});
+        qDebug() << "Added file" << path;
     } else {
         if (url.isValid() && !url.isLocalFile()) {
             qDebug() << "Adding" << url.toString() << "as remote file";
-            paths.append(path);
-            m_pathMap.insert(path, paths);
-            m_allFiles.append(path);
-            Q_EMIT countChanged();
+            addFiles(path, {path});
         } else {
             qWarning() << "Path" << path << "is not a valid file url or directory";
         }
     }
 }
 
+DirectoryIndexer *MediaFrame::startIndexing(const QString &path, const QString &localPath, bool recursive)
+{
+    DirectoryIndexer *indexer = new DirectoryIndexer(localPath, m_filters, recursive);
+    m_indexers.insert(indexer);
+    connect(indexer, &DirectoryIndexer::finished, indexer, &QObject::deleteLater);
+    connect(indexer, &DirectoryIndexer::filesFound, this, [this, path, generation = m_indexingGeneration](const QStringList &files) {
+        // batches queued before the indexer was cancelled are still delivered
+        if (generation == m_indexingGeneration) {
+            addFiles(path, files);
+        }
+    });
+    connect(indexer, &DirectoryIndexer::finished, this, [this, indexer]() {
+        m_indexers.remove(indexer);
+    });
+    QThreadPool::globalInstance()->start(indexer);
+    return indexer;
+}
+
+void MediaFrame::addFiles(const QString &path, const QStringList &files)
+{
+    int added = 0;
+    for (const QString &file : files) {
+        // the directory watch might have reported the file already
+        if (m_allFiles.contains(file)) {
+            continue;
+        }
+        m_allFiles.append(file);
+        ++added;
+    }
+
+    if (added > 0) {
+        m_pathMap[path] += added;
+        Q_EMIT countChanged();
+    }
+}
+
+bool MediaFrame::removeFile(const QString &path, const QString &file)
+{
+    const int index = m_allFiles.indexOf(file);
+    if (index < 0) {
+        return false;
+    }
+
+    if (m_random) {
+        // the last file is moved into the gap, that way the removal does not shift the whole list
+        m_allFiles.removeAtUnordered(index);
+    } else {
+        // the slideshow goes through the files in order, it continues with the file after the removed one
+        m_allFiles.removeAt(index);
+        if (m_next > index) {
+            --m_next;
+        }
+    }
+    if (m_next >= m_allFiles.count()) {
+        m_next = 0;
+    }
+    m_upcoming.removeAll(file);
+
+    // entries of the removed file keep its path, those of moved ones follow them
+    for (QVector<HistoryEntry> *entries : {&m_history, &m_future}) {
+        for (HistoryEntry &entry : *entries) {
+            if (entry.index == index) {
+                entry = HistoryEntry{-1, file};
+            } else if (m_random && entry.index == m_allFiles.count()) {
+                entry.index = index;
+            } else if (!m_random && entry.index > index) {
+                --entry.index;
+            }
+        }
+    }
+
+    --m_pathMap[path];
+    return true;
+}
+
+QHash<QString, MediaFrame::WatchedDir>::const_iterator MediaFrame::watchedDir(const QString &localPath) const
+{
+    for (auto it = m_watchedDirs.cbegin(), end = m_watchedDirs.cend(); it != end; ++it) {
+        if (localPath == it.key() || localPath.startsWith(it.key() + QLatin1Char('/'))) {
+            return it;
+        }
+    }
+    return m_watchedDirs.cend();
+}
+
+void MediaFrame::slotDirty(const QString &localPath)
+{
+    const auto dir = watchedDir(localPath);
+    if (dir == m_watchedDirs.cend() || !QFileInfo(localPath).isDir()) {
+        return;
+    }
+    rescan(dir->path, QDir::cleanPath(localPath));
+}
+
+void MediaFrame::rescan(const QString &path, const QString &localDir)
+{
+    // several changes in a row are picked up by one more listing once the current one is done
+    if (m_rescans.contains(localDir)) {
+        m_pendingRescans.insert(localDir);
+        return;
+    }
+    m_rescans.insert(localDir);
+
+    DirectoryIndexer *indexer = startIndexing(path, localDir, false);
+    indexer->setPersistent(false);
+
+    // new files are added by startIndexing() already, the complete listing tells the removed ones
+    QSharedPointer<QSet<QString>> listed(new QSet<QString>);
+    connect(indexer, &DirectoryIndexer::filesFound, this, [listed](const QStringList &files) {
+        for (const QString &file : files) {
+            listed->insert(file);
+        }
+    });
+    connect(indexer, &DirectoryIndexer::finished, this, [this, path, localDir, listed, generation = m_indexingGeneration]() {
+        if (generation != m_indexingGeneration) {
+            return;
+        }
+
+        bool removed = false;
+        const QStringList files = m_allFiles.filesIn(localDir);
+        for (const QString &file : files) {
+            if (!listed->contains(file)) {
+                removed = removeFile(path, file) || removed;
+            }
+        }
+        if (removed) {
+            Q_EMIT countChanged();
+        }
+
+        m_rescans.remove(localDir);
+        if (m_pendingRescans.remove(localDir)) {
+            rescan(path, localDir);
+        }
+    });
+}
+
+void MediaFrame::slotCreated(const QString &localPath)
+{
+    const auto dir = watchedDir(localPath);
+    if (dir == m_watchedDirs.cend()) {
+        return;
+    }
+
+    const QFileInfo info(localPath);
+    if (info.isDir()) {
+        // e.g. a folder moved into the collection, only that one has to be walked
+        if (dir->recursive) {
+            startIndexing(dir->path, localPath, true)->setPersistent(false);
+        }
+    } else if (QDir::match(m_filters, info.fileName())) {
+        addFiles(dir->path, {localPath});
+    }
+}
+
+void MediaFrame::slotDeleted(const QString &localPath)
+{
+    const auto dir = watchedDir(localPath);
+    if (dir == m_watchedDirs.cend()) {
+        return;
+    }
+
+    bool removed = removeFile(dir->path, localPath);
+    if (!removed) {
+        // a removed directory, drop everything that was below it
+        const QStringList files = m_allFiles.filesBelow(localPath);
+        for (const QString &file : qAsConst(files)) {
+            removed = removeFile(dir->path, file) || removed;
+        }
+    }
+
+    if (removed) {
+        Q_EMIT countChanged();
+    }
+}
+
+void MediaFrame::cancelIndexing()
+{
+    for (DirectoryIndexer *indexer : qAsConst(m_indexers)) {
+        // the indexer deletes itself once it stopped
+        disconnect(indexer, nullptr, this, nullptr);
+        indexer->cancel();
+    }
+    m_indexers.clear();
+    m_rescans.clear();
+    m_pendingRescans.clear();
+    ++m_indexingGeneration;
+}
+
 void MediaFrame::clear()
 {
+    cancelIndexing();
+    for (auto it = m_watchedDirs.cbegin(), end = m_watchedDirs.cend(); it != end; ++it) {
+        m_dirWatch.removeDir(it.key());
+    }
+    m_watchedDirs.clear();
     m_pathMap.clear();
+    detachHistory();
     m_allFiles.clear();
+    m_upcoming.clear();
     Q_EMIT countChanged();
 }
 
@@ -228,16 +430,8 @@ void MediaFrame::get(QJSValue successCallback, QJSValue errorCallback)
         }
     }
 
-    if (m_random) {
-        path = m_allFiles.at(this->random(0, size));
-    } else {
-        path = m_allFiles.at(m_next);
-        m_next++;
-        if (m_next > size) {
-            qDebug() << "Resetting next count from" << m_next << "due to queue size" << size;
-            m_next = 0;
-        }
-    }
+    path = m_upcoming.isEmpty() ? pick() : m_upcoming.takeFirst();
+    preloadUpcoming();
 
     QUrl url = QUrl(path);
 
@@ -245,29 +439,26 @@ void MediaFrame::get(QJSValue successCallback, QJSValue errorCallback)
         QString localPath = url.toString(QUrl::PreferLocalFile);
 
         if (!isFile(localPath)) {
-            m_filename = path.section(QLatin1Char('/'), -1);
+            const QString cached = cachedFile(path);
 
-            QString cachedFile = getCacheDirectory() + QLatin1Char('/') + hash(path) + QLatin1Char('_') + m_filename;
-
-            if (isFile(cachedFile)) {
+            if (isFile(cached)) {
                 // File has been cached
-                qDebug() << path << "is cached as" << cachedFile;
+                qDebug() << path << "is cached as" << cached;
+
+                // show the cached copy right away, a changed image is picked up the next time
+                if (QFileInfo(cached).lastModified().secsTo(QDateTime::currentDateTime()) > REVALIDATE_AFTER) {
+                    fetch(url, cached);
+                }
 
                 if (successCallback.isCallable()) {
-                    args << QJSValue(cachedFile);
+                    args << QJSValue(cached);
                     successCallback.call(args);
                 }
                 return;
             }
 
-            m_successCallback = successCallback;
-            m_errorCallback = errorCallback;
-            m_filename = cachedFile;
-
             qDebug() << path << "doesn't exist locally, trying remote.";
-
-            KIO::StoredTransferJob *job = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
-            connect(job, &KJob::finished, this, &MediaFrame::slotFinished);
+            fetch(url, cached, successCallback, errorCallback);
 
         } else {
             if (successCallback.isCallable()) {
@@ -288,15 +479,138 @@ void MediaFrame::get(QJSValue successCallback, QJSValue errorCallback)
     }
 }
 
+QString MediaFrame::pick()
+{
+    const int size = m_allFiles.count() - 1;
+    QString path;
+
+    if (m_random) {
+        // every file is shown once before any is repeated, new files join the current cycle
+        // while removed ones start a new cycle
+        const quint32 count = m_allFiles.count();
+        if (m_shuffle.size() < count) {
+            m_shuffle.grow(count);
+        }
+        if (m_shuffle.atEnd() || m_shuffle.size() > count) {
+            m_shuffle.reset(count);
+        }
+        path = m_allFiles.at(m_shuffle.next());
+    } else {
+        path = m_allFiles.at(m_next);
+        m_next++;
+        if (m_next > size) {
+            qDebug() << "Resetting next count from" << m_next << "due to queue size" << size;
+            m_next = 0;
+        }
+    }
+    return path;
+}
+
+void MediaFrame::preloadUpcoming()
+{
+    while (m_upcoming.count() < LOOKAHEAD) {
+        m_upcoming.append(pick());
+    }
+
+    if (m_preloadSize.isEmpty()) {
+        return;
+    }
+
+    for (const QString &path : qAsConst(m_upcoming)) {
+        const QUrl url(path);
+        const QString localPath = url.toString(QUrl::PreferLocalFile);
+        if (isFile(localPath)) {
+            ImagePreloader::self()->preload(localPath, m_preloadSize);
+        } else if (url.isValid()) {
+            // download remote images early, so get() finds them in the cache
+            const QString cached = cachedFile(path);
+            if (!isFile(cached)) {
+                fetch(url, cached);
+            }
+        }
+    }
+}
+
+QString MediaFrame::cachedFile(const QString &path)
+{
+    return getCacheDirectory() + QLatin1Char('/') + hash(path) + QLatin1Char('_') + path.section(QLatin1Char('/'), -1);
+}
+
+void MediaFrame::fetch(const QUrl &url, const QString &cachedFile, const QJSValue &successCallback, const QJSValue &errorCallback)
+{
+    // requests for an image which is already being downloaded wait for that download
+    auto it = m_fetches.find(cachedFile);
+    if (it == m_fetches.end()) {
+        it = m_fetches.insert(cachedFile, Fetch{url, {}});
+        m_fetchQueue.append(cachedFile);
+    }
+    if (successCallback.isCallable() || errorCallback.isCallable()) {
+        it->callbacks.append(qMakePair(successCallback, errorCallback));
+        // images someone is waiting for are downloaded before the prefetched ones
+        const int index = m_fetchQueue.indexOf(cachedFile);
+        if (index > 0) {
+            m_fetchQueue.move(index, 0);
+        }
+    }
+
+    startFetches();
+}
+
+void MediaFrame::startFetches()
+{
+    while (m_runningFetches < MAX_FETCHES && !m_fetchQueue.isEmpty()) {
+        const QString cachedFile = m_fetchQueue.takeFirst();
+
+        KIO::StoredTransferJob *job = KIO::storedGet(m_fetches.value(cachedFile).url, KIO::NoReload, KIO::HideProgressInfo);
+        // have the HTTP cache revalidate its copy, an unchanged image is not transferred again
+        job->addMetaData(QStringLiteral("cache"), QStringLiteral("verify"));
+        job->setProperty("cachedFile", cachedFile);
+        connect(job, &KJob::finished, this, &MediaFrame::slotFinished);
+        ++m_runningFetches;
+    }
+}
+
+QString MediaFrame::imageUrl(const QString &path)
+{
+    const QString localPath = QUrl(path).toString(QUrl::PreferLocalFile);
+    if (!isFile(localPath)) {
+        return path;
+    }
+
+    return QLatin1String("image://mediaframe/")
+        + QString::fromLatin1(localPath.toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+MediaFrame::HistoryEntry MediaFrame::historyEntry(const QString &path) const
+{
+    const int index = m_allFiles.indexOf(path);
+    return index >= 0 ? HistoryEntry{index, QString()} : HistoryEntry{-1, path};
+}
+
+QString MediaFrame::historyPath(const HistoryEntry &entry) const
+{
+    return entry.index >= 0 ? m_allFiles.at(entry.index) : entry.path;
+}
+
+void MediaFrame::detachHistory()
+{
+    // store the paths before the indices become invalid
+    for (QVector<HistoryEntry> *entries : {&m_history, &m_future}) {
+        for (HistoryEntry &entry : *entries) {
+            entry = HistoryEntry{-1, historyPath(entry)};
+        }
+    }
+}
+
 void MediaFrame::pushHistory(const QString &string)
 {
     const int oldCount = m_history.count();
 
-    m_history.prepend(string);
+    m_history.append(historyEntry(string));
 
     // Keep a sane history size
-    if (m_history.length() > 50) {
-        m_history.removeLast();
+    if (m_history.count() > 50) {
+        m_history.removeFirst();
     }
 
     if (oldCount != m_history.count()) {
@@ -310,19 +624,19 @@ QString MediaFrame::popHistory()
         return QString();
     }
 
-    const QString item = m_history.takeFirst();
+    const QString item = historyPath(m_history.takeLast());
     Q_EMIT historyLengthChanged();
     return item;
 }
 
 int MediaFrame::historyLength() const
 {
-    return m_history.length();
+    return m_history.count();
 }
 
 void MediaFrame::pushFuture(const QString &string)
 {
-    m_future.prepend(string);
+    m_future.append(historyEntry(string));
     Q_EMIT futureLengthChanged();
 }
 
@@ -332,14 +646,14 @@ QString MediaFrame::popFuture()
         return QString();
     }
 
-    const QString item = m_future.takeFirst();
+    const QString item = historyPath(m_future.takeLast());
     Q_EMIT futureLengthChanged();
     return item;
 }
 
 int MediaFrame::futureLength() const
 {
-    return m_future.length();
+    return m_future.count();
 }
 
 void MediaFrame::slotItemChanged(const QString &path)
@@ -349,41 +663,43 @@ void MediaFrame::slotItemChanged(const QString &path)
 
 void MediaFrame::slotFinished(KJob *job)
 {
+    --m_runningFetches;
+
+    const QString path = job->property("cachedFile").toString();
+    const Fetch fetch = m_fetches.take(path);
     QString errorMessage;
-    QJSValueList args;
 
     if (job->error()) {
         errorMessage = QLatin1String("Error loading image: ") + job->errorString();
-        qCritical() << errorMessage;
-
-        if (m_errorCallback.isCallable()) {
-            args << QJSValue(errorMessage);
-            m_errorCallback.call(args);
-        }
     } else if (KIO::StoredTransferJob *transferJob = qobject_cast<KIO::StoredTransferJob *>(job)) {
-        QImage image;
-
-        // TODO make proper caching calls
-        QString path = m_filename;
-        qDebug() << "Saving download to" << path;
+        const QByteArray data = transferJob->data();
 
-        image.loadFromData(transferJob->data());
-        image.save(path);
-
-        qDebug() << "Saved to" << path;
-
-        if (m_successCallback.isCallable()) {
-            args << QJSValue(path);
-            m_successCallback.call(args);
+        QFile cached(path);
+        if (cached.size() == data.size() && cached.open(QIODevice::ReadWrite) && cached.readAll() == data) {
+            // unchanged, only mark it as fresh
+            cached.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        } else {
+            // the downloaded bytes are stored as they are, the image is only decoded for display
+            qDebug() << "Saving download to" << path;
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+                errorMessage = QLatin1String("Could not save download to ") + path;
+            }
         }
     } else {
         errorMessage = QStringLiteral("Unknown error occurred");
+    }
 
+    if (!errorMessage.isEmpty()) {
         qCritical() << errorMessage;
+    }
 
-        if (m_errorCallback.isCallable()) {
-            args << QJSValue(errorMessage);
-            m_errorCallback.call(args);
+    for (const auto &callbacks : fetch.callbacks) {
+        const QJSValue &callback = errorMessage.isEmpty() ? callbacks.first : callbacks.second;
+        if (callback.isCallable()) {
+            QJSValue(callback).call(QJSValueList{QJSValue(errorMessage.isEmpty() ? path : errorMessage)});
         }
     }
+
+    startFetches();
 }
@@ -11,11 +11,22 @@
 #include <QHash>
 #include <QJSValue>
 #include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QSize>
 #include <QString>
 #include <QStringList>
+#include <QUrl>
+#include <QVector>
 
+#include <KDirWatch>
 #include <KIO/Job>
 
+#include "filelist.h"
+#include "shuffleorder.h"
+
+class DirectoryIndexer;
+
 class MediaFrame : public QObject
 {
     Q_OBJECT
@@ -24,6 +35,7 @@ class MediaFrame : public QObject
     Q_PROPERTY(int historyLength READ historyLength NOTIFY historyLengthChanged)
     Q_PROPERTY(int futureLength READ futureLength NOTIFY futureLengthChanged)
     Q_PROPERTY(bool random READ random WRITE setRandom NOTIFY randomChanged)
+    Q_PROPERTY(QSize preloadSize READ preloadSize WRITE setPreloadSize NOTIFY preloadSizeChanged)
 
 public:
     enum AddOption {
@@ -43,6 +55,13 @@ public:
     bool random() const;
     void setRandom(bool random);
 
+    /**
+     * The size in device pixels the images are shown at, the upcoming
+     * images are decoded at that size in advance.
+     */
+    QSize preloadSize() const;
+    void setPreloadSize(const QSize &size);
+
     Q_INVOKABLE bool isDir(const QString &path);
     Q_INVOKABLE bool isDirEmpty(const QString &path);
     Q_INVOKABLE bool isFile(const QString &path);
@@ -55,6 +74,12 @@ public:
 
     Q_INVOKABLE bool isAdded(const QString &path);
 
+    /**
+     * Returns the url to show @p path with, local images are served by the
+     * image provider which can use the preloaded images.
+     */
+    Q_INVOKABLE QString imageUrl(const QString &path);
+
     Q_INVOKABLE void get(QJSValue callback);
     Q_INVOKABLE void get(QJSValue callback, QJSValue error_callback);
 
@@ -69,32 +94,86 @@ Q_SIGNALS:
     void historyLengthChanged();
     void futureLengthChanged();
     void randomChanged();
+    void preloadSizeChanged();
     void itemChanged(const QString &path);
 
 private Q_SLOTS:
     void slotItemChanged(const QString &path);
     void slotFinished(KJob *job);
+    void slotDirty(const QString &path);
+    void slotCreated(const QString &path);
+    void slotDeleted(const QString &path);
 
 private:
-    int random(int min, int max);
+    struct WatchedDir {
+        QString path;
+        bool recursive;
+    };
+
+    // a file of the collection by its index, or a path that is not part of it
+    struct HistoryEntry {
+        int index;
+        QString path;
+    };
+
+    struct Fetch {
+        QUrl url;
+        // success and error callback of each get() waiting for the download
+        QVector<QPair<QJSValue, QJSValue>> callbacks;
+    };
+
+    QString pick();
+    void preloadUpcoming();
+    QString cachedFile(const QString &path);
+    void fetch(const QUrl &url, const QString &cachedFile, const QJSValue &successCallback = QJSValue(), const QJSValue &errorCallback = QJSValue());
+    void startFetches();
+    DirectoryIndexer *startIndexing(const QString &path, const QString &localPath, bool recursive);
+    void cancelIndexing();
+    /**
+     * Lists @p localDir again on the indexer thread and adds or removes
+     * the files that changed.
+     */
+    void rescan(const QString &path, const QString &localDir);
+    void addFiles(const QString &path, const QStringList &files);
+    bool removeFile(const QString &path, const QString &file);
+    QHash<QString, WatchedDir>::const_iterator watchedDir(const QString &localPath) const;
+    HistoryEntry historyEntry(const QString &path) const;
+    QString historyPath(const HistoryEntry &entry) const;
+    void detachHistory();
     QString getCacheDirectory();
     QString hash(const QString &str);
 
     QStringList m_filters;
-    QHash<QString, QStringList> m_pathMap;
-    QStringList m_allFiles;
+    // number of files found for each added path
+    QHash<QString, int> m_pathMap;
+    FileList m_allFiles;
+    QSet<DirectoryIndexer *> m_indexers;
+    // changes when the running indexers are cancelled, their results are dropped then
+    quint64 m_indexingGeneration = 0;
     QString m_watchFile;
     QFileSystemWatcher m_watcher;
-
-    QStringList m_history;
-    QStringList m_future;
-
-    QJSValue m_successCallback;
-    QJSValue m_errorCallback;
-    QString m_filename;
+    // the added directories by their local path
+    QHash<QString, WatchedDir> m_watchedDirs;
+    KDirWatch m_dirWatch;
+    // directories listed again after a change, and those that changed again meanwhile
+    QSet<QString> m_rescans;
+    QSet<QString> m_pendingRescans;
+
+    // most recent entries last
+    QVector<HistoryEntry> m_history;
+    QVector<HistoryEntry> m_future;
+    // the next files get() returns, decoded in advance
+    QStringList m_upcoming;
+    QSize m_preloadSize;
+
+    // pending downloads by the file they are cached as
+    QHash<QString, Fetch> m_fetches;
+    QStringList m_fetchQueue;
+    int m_runningFetches = 0;
 
     bool m_random = false;
     int m_next = 0;
+    ShuffleOrder m_shuffle;
 };
 
 #endif
@@ -0,0 +1,26 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "mediaframeimageprovider.h"
+#include "imagepreloader.h"
+
+MediaFrameImageProvider::MediaFrameImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+{
+}
+
+QImage MediaFrameImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    const QString file = QString::fromUtf8(QByteArray::fromBase64(id.toLatin1(), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+
+    QImage image = ImagePreloader::self()->image(file, requestedSize);
+    if (image.isNull()) {
+        image = ImagePreloader::decode(file, requestedSize);
+    }
+
+    *size = image.size();
+    return image;
+}
@@ -0,0 +1,26 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef MEDIAFRAMEIMAGEPROVIDER_H
+#define MEDIAFRAMEIMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+
+/**
+ * Serves the slideshow images, preferably the ones ImagePreloader
+ * already decoded in the background.
+ *
+ * The id is the base64 encoded path of the image, see MediaFrame::imageUrl().
+ */
+class MediaFrameImageProvider : public QQuickImageProvider
+{
+public:
+    MediaFrameImageProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+};
+
+#endif
@@ -6,6 +6,7 @@
 
 #include "mediaframeplugin.h"
 #include "mediaframe.h"
+#include "mediaframeimageprovider.h"
 
 // Qt
 
@@ -15,3 +16,9 @@ void MediaFramePlugin::registerTypes(const char *uri)
 
     qmlRegisterType<MediaFrame>(uri, 2, 0, "MediaFrame");
 }
+
+void MediaFramePlugin::initializeEngine(QQmlEngine *engine, const char *uri)
+{
+    Q_UNUSED(uri)
+    engine->addImageProvider(QStringLiteral("mediaframe"), new MediaFrameImageProvider());
+}
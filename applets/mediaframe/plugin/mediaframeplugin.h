@@ -17,6 +17,7 @@ class MediaFramePlugin : public QQmlExtensionPlugin
 
 public:
     void registerTypes(const char *uri) override;
+    void initializeEngine(QQmlEngine *engine, const char *uri) override;
 };
 
 #endif
@@ -0,0 +1,142 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "renditioncache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QImageReader>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+// renditions are stored in steps of this many pixels
+static const int SIZE_STEP = 256;
+// the cache is trimmed to 3/4 of this many bytes once it grows beyond it
+static const qint64 CACHE_LIMIT = 256 * 1024 * 1024;
+// number of stored renditions after which the cache size is checked again
+static const int TRIM_INTERVAL = 32;
+
+static QMutex s_trimMutex;
+static int s_storedSinceTrim = TRIM_INTERVAL;
+
+static QString cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/plasma_mediaframe/renditions/");
+}
+
+static QString renditionPath(const QFileInfo &original, int renditionSize)
+{
+    const QString key = original.absoluteFilePath() + QLatin1Char(':') + QString::number(original.lastModified().toMSecsSinceEpoch()) + QLatin1Char(':')
+        + QString::number(original.size());
+    return cacheDirectory() + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex()) + QLatin1Char('_')
+        + QString::number(renditionSize);
+}
+
+static QImage loadThumbnail(const QFileInfo &original, int renditionSize)
+{
+    static const struct {
+        int size;
+        const char *directory;
+    } thumbnailSizes[] = {{128, "normal"}, {256, "large"}, {512, "x-large"}, {1024, "xx-large"}};
+
+    const QByteArray uri = QUrl::fromLocalFile(original.absoluteFilePath()).toEncoded();
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(uri, QCryptographicHash::Md5).toHex()) + QLatin1String(".png");
+    const QString thumbnailDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/thumbnails/");
+
+    for (const auto &thumbnailSize : thumbnailSizes) {
+        if (thumbnailSize.size < renditionSize) {
+            continue;
+        }
+
+        QImageReader reader(thumbnailDir + QLatin1String(thumbnailSize.directory) + QLatin1Char('/') + name);
+        if (!reader.canRead()) {
+            continue;
+        }
+        // a thumbnail of an older version of the file
+        if (reader.text(QStringLiteral("Thumb::MTime")) != QString::number(original.lastModified().toSecsSinceEpoch())) {
+            continue;
+        }
+        const QImage thumbnail = reader.read();
+        // thumbnails are never larger than the image, so a small image might not fill the thumbnail size
+        if (!thumbnail.isNull() && qMax(thumbnail.width(), thumbnail.height()) >= renditionSize) {
+            return thumbnail;
+        }
+    }
+
+    return QImage();
+}
+
+static void trim()
+{
+    QDir dir(cacheDirectory());
+    const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time);
+
+    qint64 size = 0;
+    for (const QFileInfo &entry : entries) {
+        size += entry.size();
+    }
+    if (size <= CACHE_LIMIT) {
+        return;
+    }
+
+    // loading a rendition touches it, so the oldest ones are the least recently used
+    for (auto it = entries.crbegin(); it != entries.crend() && size > CACHE_LIMIT * 3 / 4; ++it) {
+        size -= it->size();
+        QFile::remove(it->absoluteFilePath());
+    }
+    qDebug() << "Trimmed rendition cache to" << size << "bytes";
+}
+
+int RenditionCache::renditionSize(const QSize &imageSize, const QSize &size)
+{
+    const QSize scaledSize = imageSize.scaled(size, Qt::KeepAspectRatioByExpanding);
+    const int longerSide = qMax(scaledSize.width(), scaledSize.height());
+    return ((longerSide + SIZE_STEP - 1) / SIZE_STEP) * SIZE_STEP;
+}
+
+QImage RenditionCache::load(const QFileInfo &original, int renditionSize)
+{
+    QImage image = loadThumbnail(original, renditionSize);
+    if (!image.isNull()) {
+        return image;
+    }
+
+    const QString path = renditionPath(original, renditionSize);
+    if (!image.load(path)) {
+        return QImage();
+    }
+
+    QFile file(path);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return image;
+}
+
+void RenditionCache::store(const QFileInfo &original, int renditionSize, const QImage &image)
+{
+    QDir().mkpath(cacheDirectory());
+
+    QSaveFile file(renditionPath(original, renditionSize));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    // photos are stored lossy, anything with transparency lossless
+    if (!image.save(&file, image.hasAlphaChannel() ? "PNG" : "JPEG", image.hasAlphaChannel() ? -1 : 90) || !file.commit()) {
+        qWarning() << "Could not cache rendition of" << original.absoluteFilePath();
+        return;
+    }
+
+    QMutexLocker locker(&s_trimMutex);
+    if (++s_storedSinceTrim >= TRIM_INTERVAL) {
+        s_storedSinceTrim = 0;
+        trim();
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef RENDITIONCACHE_H
+#define RENDITIONCACHE_H
+
+#include <QFileInfo>
+#include <QImage>
+#include <QSize>
+
+/**
+ * On-disk cache of downscaled copies of the slideshow images.
+ *
+ * Renditions are keyed by path, modification time and file size of the
+ * original and stored in steps of 256 pixels of their longer side, so
+ * small changes of the applet size still hit the cache. Thumbnails
+ * following the freedesktop.org thumbnail specification are used as well
+ * when they are large enough. The least recently used renditions are
+ * removed once the cache exceeds its size limit.
+ */
+namespace RenditionCache
+{
+/**
+ * Returns the size of the longer side of the rendition used for showing
+ * an image of @p imageSize at @p size.
+ */
+int renditionSize(const QSize &imageSize, const QSize &size);
+
+/**
+ * Returns a cached rendition of @p original whose longer side is at least
+ * @p renditionSize, or a null image.
+ */
+QImage load(const QFileInfo &original, int renditionSize);
+
+/**
+ * Stores @p image as the rendition of @p original for @p renditionSize.
+ */
+void store(const QFileInfo &original, int renditionSize, const QImage &image);
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "shuffleorder.h"
+
+#include <QRandomGenerator>
+
+static quint32 mix(quint32 value, quint32 key)
+{
+    value ^= key;
+    value *= 0x9e3779b1u;
+    value ^= value >> 16;
+    value *= 0x85ebca6bu;
+    value ^= value >> 13;
+    return value;
+}
+
+ShuffleOrder::ShuffleOrder()
+{
+    // the first cycle may start by growing from an empty range, it needs its own keys as well
+    QRandomGenerator::global()->fillRange(m_keys);
+}
+
+void ShuffleOrder::reset(quint32 size)
+{
+    m_visited.fill(false, size);
+    m_visitedCount = 0;
+    setSize(size);
+
+    QRandomGenerator::global()->fillRange(m_keys);
+}
+
+void ShuffleOrder::grow(quint32 size)
+{
+    Q_ASSERT(size >= m_size);
+    m_visited.resize(size);
+    setSize(size);
+}
+
+void ShuffleOrder::setSize(quint32 size)
+{
+    m_size = size;
+    // the permutation changes with the size, the visited indices are skipped when walking it again
+    m_step = 0;
+
+    // the network permutes 2 * m_halfBits bits, that is at most four times the size
+    m_halfBits = 1;
+    while (m_halfBits < 16 && (quint64(1) << (2 * m_halfBits)) < size) {
+        ++m_halfBits;
+    }
+}
+
+quint32 ShuffleOrder::next()
+{
+    Q_ASSERT(!atEnd());
+    quint32 index;
+    do {
+        index = permute(m_step++);
+    } while (m_visited.testBit(index));
+
+    m_visited.setBit(index);
+    ++m_visitedCount;
+    return index;
+}
+
+quint32 ShuffleOrder::permute(quint32 value) const
+{
+    const quint32 mask = (quint32(1) << m_halfBits) - 1;
+
+    // cycle walking: values outside of the range are permuted again until they
+    // fall into it, which keeps it a permutation of 0 to m_size - 1
+    do {
+        quint32 left = value >> m_halfBits;
+        quint32 right = value & mask;
+        for (int round = 0; round < ROUNDS; ++round) {
+            const quint32 newRight = left ^ (mix(right, m_keys[round]) & mask);
+            left = right;
+            right = newRight;
+        }
+        value = (left << m_halfBits) | right;
+    } while (value >= m_size);
+
+    return value;
+}
@@ -0,0 +1,69 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef SHUFFLEORDER_H
+#define SHUFFLEORDER_H
+
+#include <QBitArray>
+
+/**
+ * A random order of the indices 0 to size - 1 that is computed step by step.
+ *
+ * Every index is visited exactly once per cycle. The order is a keyed Feistel
+ * permutation, so besides one bit per index for the visited ones no memory is
+ * needed and each step costs constant time on average. Growing the range keeps
+ * the cycle, the new indices are mixed into the remaining ones.
+ */
+class ShuffleOrder
+{
+public:
+    ShuffleOrder();
+
+    /**
+     * Starts a new random cycle over @p size indices.
+     */
+    void reset(quint32 size);
+
+    /**
+     * Enlarges the range to @p size indices without starting a new cycle.
+     * The indices visited already in the current cycle are not visited again.
+     */
+    void grow(quint32 size);
+
+    quint32 size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Returns true if all indices of the current cycle have been visited.
+     */
+    bool atEnd() const
+    {
+        return m_visitedCount >= m_size;
+    }
+
+    /**
+     * Returns the next index of the cycle, must not be called at its end.
+     */
+    quint32 next();
+
+private:
+    void setSize(quint32 size);
+    quint32 permute(quint32 value) const;
+
+    static const int ROUNDS = 4;
+
+    quint32 m_size = 0;
+    // position in the permutation, it starts over after growing
+    quint32 m_step = 0;
+    quint32 m_visitedCount = 0;
+    QBitArray m_visited;
+    int m_halfBits = 1;
+    quint32 m_keys[ROUNDS] = {};
+};
+
+#endif
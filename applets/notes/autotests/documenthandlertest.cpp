@@ -0,0 +1,128 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "documenthandler.h"
+
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickTextDocument>
+#include <QScopedPointer>
+#include <QSignalSpy>
+#include <QTest>
+#include <QTextCursor>
+#include <QTextDocument>
+
+class DocumentHandlerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testChangedSignals();
+    void benchmarkKeystroke();
+
+private:
+    QTextDocument *document() const;
+
+    QQmlEngine m_engine;
+    QScopedPointer<QQuickItem> m_textEdit;
+};
+
+void DocumentHandlerTest::init()
+{
+    // like the text area of the applet
+    QQmlComponent component(&m_engine);
+    component.setData("import QtQuick 2.0\nTextEdit { textFormat: TextEdit.RichText; width: 400 }", QUrl());
+    m_textEdit.reset(qobject_cast<QQuickItem *>(component.create()));
+    QVERIFY2(m_textEdit, qPrintable(component.errorString()));
+}
+
+void DocumentHandlerTest::cleanup()
+{
+    m_textEdit.reset();
+}
+
+QTextDocument *DocumentHandlerTest::document() const
+{
+    return m_textEdit->property("textDocument").value<QQuickTextDocument *>()->textDocument();
+}
+
+void DocumentHandlerTest::testChangedSignals()
+{
+    m_textEdit->setProperty("text", QStringLiteral("<p>plain <b>bold</b> <i>italic</i></p>"));
+
+    DocumentHandler handler;
+    handler.setTarget(m_textEdit.data());
+    handler.setCursorPosition(2);
+    QTest::qWait(10);
+    QVERIFY(!handler.bold());
+
+    QSignalSpy boldSpy(&handler, &DocumentHandler::boldChanged);
+    QSignalSpy italicSpy(&handler, &DocumentHandler::italicChanged);
+    QSignalSpy fontFamilySpy(&handler, &DocumentHandler::fontFamilyChanged);
+    QSignalSpy fontSizeSpy(&handler, &DocumentHandler::fontSizeChanged);
+    QSignalSpy textColorSpy(&handler, &DocumentHandler::textColorChanged);
+    QSignalSpy alignmentSpy(&handler, &DocumentHandler::alignmentChanged);
+
+    // moving within text of the same format changes nothing
+    handler.setCursorPosition(3);
+    QTest::qWait(10);
+    QCOMPARE(boldSpy.count(), 0);
+    QCOMPARE(italicSpy.count(), 0);
+
+    // the format right before the cursor applies
+    handler.setCursorPosition(8);
+    QTest::qWait(10);
+    QVERIFY(handler.bold());
+    QCOMPARE(boldSpy.count(), 1);
+    QCOMPARE(italicSpy.count(), 0);
+
+    // several moves within one event loop pass are looked at once
+    handler.setCursorPosition(4);
+    handler.setCursorPosition(13);
+    QTest::qWait(10);
+    QVERIFY(!handler.bold());
+    QVERIFY(handler.italic());
+    QCOMPARE(boldSpy.count(), 2);
+    QCOMPARE(italicSpy.count(), 1);
+
+    QCOMPARE(fontFamilySpy.count(), 0);
+    QCOMPARE(fontSizeSpy.count(), 0);
+    QCOMPARE(textColorSpy.count(), 0);
+    QCOMPARE(alignmentSpy.count(), 0);
+}
+
+void DocumentHandlerTest::benchmarkKeystroke()
+{
+    // a pasted log of 5 MB
+    const QString line = QStringLiteral("2021-03-01 12:00:00.000 kwin_core: Failed to focus 0x3a00004 (window not visible)\n");
+    QString log;
+    log.reserve(5 * 1024 * 1024 + line.size());
+    while (log.size() < 5 * 1024 * 1024) {
+        log += line;
+    }
+    document()->setPlainText(log);
+
+    DocumentHandler handler;
+    handler.setTarget(m_textEdit.data());
+    int position = log.size() / 2;
+    handler.setCursorPosition(position);
+    QTest::qWait(10);
+
+    QTextCursor cursor(document());
+    QBENCHMARK {
+        cursor.setPosition(position);
+        cursor.insertText(QStringLiteral("x"));
+        handler.setCursorPosition(++position);
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(handler.cursorPosition(), position);
+}
+
+QTEST_MAIN(DocumentHandlerTest)
+
+#include "documenthandlertest.moc"
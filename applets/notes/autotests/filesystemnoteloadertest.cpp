@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "filesystemnoteloader.h"
+#include "note.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+
+class FileSystemNoteLoaderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+    void testSearchNewNote();
+    void testExternalChange();
+    void testIsNoteFile();
+};
+
+static QString notesPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma_notes");
+}
+
+void FileSystemNoteLoaderTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(notesPath()).removeRecursively();
+}
+
+void FileSystemNoteLoaderTest::cleanup()
+{
+    QDir(notesPath()).removeRecursively();
+}
+
+void FileSystemNoteLoaderTest::testSearchNewNote()
+{
+    FileSystemNoteLoader loader;
+
+    // new notes are named by a bare UUID
+    Note *note = loader.loadNote(QString());
+    QVERIFY(!note->id().endsWith(QLatin1String(".txt")));
+    note->save(QStringLiteral("Shopping list\nmilk, eggs and flour"));
+    loader.flush();
+
+    QTRY_COMPARE(loader.search(QStringLiteral("eggs"), 10).count(), 1);
+    const NoteIndex::Result result = loader.search(QStringLiteral("shopping mil"), 10).value(0);
+    QCOMPARE(result.id, note->id());
+    QCOMPARE(result.title, QStringLiteral("Shopping list"));
+    QVERIFY(loader.search(QStringLiteral("butter"), 10).isEmpty());
+
+    // another index of the same notes, like the one of the runner, finds it as well
+    QTRY_VERIFY(QFile::exists(notesPath() + QStringLiteral("/.index")));
+    NoteIndex index(notesPath());
+    index.update();
+    QCOMPARE(index.search(QStringLiteral("flour")).value(0).id, note->id());
+
+    delete note;
+}
+
+void FileSystemNoteLoaderTest::testExternalChange()
+{
+    FileSystemNoteLoader loader;
+    Note *note = loader.loadNote(QString());
+    const QString path = notesPath() + QLatin1Char('/') + note->id();
+
+    // our own writes do not reload the note
+    note->save(QStringLiteral("first"));
+    loader.flush();
+    note->save(QStringLiteral("second"));
+    loader.flush();
+    QTRY_VERIFY(QFile::exists(path));
+    QTest::qWait(500);
+    QCOMPARE(note->noteText(), QStringLiteral("second"));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("changed elsewhere");
+    file.close();
+    QTRY_COMPARE(note->noteText(), QStringLiteral("changed elsewhere"));
+
+    delete note;
+}
+
+void FileSystemNoteLoaderTest::testIsNoteFile()
+{
+    QVERIFY(NoteIndex::isNoteFile(QStringLiteral("/notes/1f0e5a8c-1b2c-4d5e-8f90-1a2b3c4d5e")));
+    QVERIFY(NoteIndex::isNoteFile(QStringLiteral("/notes/old note.txt")));
+    QVERIFY(!NoteIndex::isNoteFile(QStringLiteral("/notes/.index")));
+    QVERIFY(!NoteIndex::isNoteFile(QStringLiteral("/notes/.index.Ab3xY9")));
+    QVERIFY(!NoteIndex::isNoteFile(QStringLiteral("/notes/1f0e5a8c-1b2c-4d5e-8f90-1a2b3c4d5e.Ab3xY9")));
+}
+
+QTEST_GUILESS_MAIN(FileSystemNoteLoaderTest)
+
+#include "filesystemnoteloadertest.moc"
@@ -8,6 +8,10 @@
 #ifndef ABSTRACTNOTELOADER_H
 #define ABSTRACTNOTELOADER_H
 
+#include <QVector>
+
+#include "noteindex.h"
+
 class QStringList;
 class QString;
 class Note;
@@ -22,6 +26,11 @@ public:
     virtual Note *loadNote(const QString &id) = 0;
     virtual void deleteNoteResources(const QString &id) = 0;
 
+    /**
+     * Returns the notes containing the words of @p query, best matches first.
+     */
+    virtual QVector<NoteIndex::Result> search(const QString &query, int limit) = 0;
+
 private:
 };
 
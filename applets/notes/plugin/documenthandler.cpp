@@ -20,6 +20,7 @@
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QTextDocumentFragment>
+#include <QTimer>
 
 DocumentHandler::DocumentHandler()
     : m_target(nullptr)
@@ -45,6 +46,7 @@ void DocumentHandler::setTarget(QQuickItem *target)
             m_doc = qqdoc->textDocument();
         }
     }
+    scheduleFormatUpdate();
     Q_EMIT targetChanged();
 }
 
@@ -103,19 +105,69 @@ void DocumentHandler::setCursorPosition(int position)
 
     m_cursorPosition = position;
 
-    reset();
+    scheduleFormatUpdate();
 }
 
 void DocumentHandler::reset()
 {
-    Q_EMIT fontFamilyChanged();
-    Q_EMIT alignmentChanged();
-    Q_EMIT boldChanged();
-    Q_EMIT italicChanged();
-    Q_EMIT underlineChanged();
-    Q_EMIT strikeOutChanged();
-    Q_EMIT fontSizeChanged();
-    Q_EMIT textColorChanged();
+    updateFormat();
+}
+
+void DocumentHandler::scheduleFormatUpdate()
+{
+    // cursor and selection change together, look at the document only once for all of them
+    if (!m_formatUpdateScheduled) {
+        m_formatUpdateScheduled = true;
+        QTimer::singleShot(0, this, &DocumentHandler::updateFormat);
+    }
+}
+
+void DocumentHandler::updateFormat()
+{
+    m_formatUpdateScheduled = false;
+
+    Format format;
+    const QTextCursor cursor = textCursor();
+    if (!cursor.isNull()) {
+        const QTextCharFormat charFormat = cursor.charFormat();
+        const QFont font = charFormat.font();
+        format.fontFamily = font.family();
+        format.textColor = charFormat.foreground().color();
+        format.alignment = cursor.blockFormat().alignment();
+        format.bold = charFormat.fontWeight() == QFont::Bold;
+        format.italic = charFormat.fontItalic();
+        format.underline = charFormat.fontUnderline();
+        format.strikeOut = charFormat.fontStrikeOut();
+        format.fontSize = font.pointSize();
+    }
+
+    const Format old = m_format;
+    m_format = format;
+
+    if (format.fontFamily != old.fontFamily) {
+        Q_EMIT fontFamilyChanged();
+    }
+    if (format.alignment != old.alignment) {
+        Q_EMIT alignmentChanged();
+    }
+    if (format.bold != old.bold) {
+        Q_EMIT boldChanged();
+    }
+    if (format.italic != old.italic) {
+        Q_EMIT italicChanged();
+    }
+    if (format.underline != old.underline) {
+        Q_EMIT underlineChanged();
+    }
+    if (format.strikeOut != old.strikeOut) {
+        Q_EMIT strikeOutChanged();
+    }
+    if (format.fontSize != old.fontSize) {
+        Q_EMIT fontSizeChanged();
+    }
+    if (format.textColor != old.textColor) {
+        Q_EMIT textColorChanged();
+    }
 }
 
 QTextCursor DocumentHandler::textCursor() const
@@ -144,12 +196,24 @@ void DocumentHandler::mergeFormatOnWordOrSelection(const QTextCharFormat &format
 
 void DocumentHandler::setSelectionStart(int position)
 {
+    if (position == m_selectionStart) {
+        return;
+    }
+
     m_selectionStart = position;
+
+    scheduleFormatUpdate();
 }
 
 void DocumentHandler::setSelectionEnd(int position)
 {
+    if (position == m_selectionEnd) {
+        return;
+    }
+
     m_selectionEnd = position;
+
+    scheduleFormatUpdate();
 }
 
 void DocumentHandler::setAlignment(Qt::Alignment a)
@@ -160,52 +224,32 @@ void DocumentHandler::setAlignment(Qt::Alignment a)
     cursor.setPosition(m_selectionStart, QTextCursor::MoveAnchor);
     cursor.setPosition(m_selectionEnd, QTextCursor::KeepAnchor);
     cursor.mergeBlockFormat(fmt);
-    Q_EMIT alignmentChanged();
+    updateFormat();
 }
 
 Qt::Alignment DocumentHandler::alignment() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return Qt::AlignLeft;
-    }
-    return textCursor().blockFormat().alignment();
+    return m_format.alignment;
 }
 
 bool DocumentHandler::bold() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return false;
-    }
-    return textCursor().charFormat().fontWeight() == QFont::Bold;
+    return m_format.bold;
 }
 
 bool DocumentHandler::italic() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return false;
-    }
-    return textCursor().charFormat().fontItalic();
+    return m_format.italic;
 }
 
 bool DocumentHandler::underline() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return false;
-    }
-    return textCursor().charFormat().fontUnderline();
+    return m_format.underline;
 }
 
 bool DocumentHandler::strikeOut() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return false;
-    }
-    return textCursor().charFormat().fontStrikeOut();
+    return m_format.strikeOut;
 }
 
 void DocumentHandler::setBold(bool arg)
@@ -213,6 +257,8 @@ void DocumentHandler::setBold(bool arg)
     QTextCharFormat fmt;
     fmt.setFontWeight(arg ? QFont::Bold : QFont::Normal);
     mergeFormatOnWordOrSelection(fmt);
+    updateFormat();
+    // the toolbar button toggled itself, make sure it shows the actual state again
     Q_EMIT boldChanged();
 }
 
@@ -221,6 +267,7 @@ void DocumentHandler::setItalic(bool arg)
     QTextCharFormat fmt;
     fmt.setFontItalic(arg);
     mergeFormatOnWordOrSelection(fmt);
+    updateFormat();
     Q_EMIT italicChanged();
 }
 
@@ -229,6 +276,7 @@ void DocumentHandler::setUnderline(bool arg)
     QTextCharFormat fmt;
     fmt.setFontUnderline(arg);
     mergeFormatOnWordOrSelection(fmt);
+    updateFormat();
     Q_EMIT underlineChanged();
 }
 
@@ -237,17 +285,13 @@ void DocumentHandler::setStrikeOut(bool arg)
     QTextCharFormat fmt;
     fmt.setFontStrikeOut(arg);
     mergeFormatOnWordOrSelection(fmt);
+    updateFormat();
     Q_EMIT strikeOutChanged();
 }
 
 int DocumentHandler::fontSize() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return 0;
-    }
-    QTextCharFormat format = cursor.charFormat();
-    return format.font().pointSize();
+    return m_format.fontSize;
 }
 
 void DocumentHandler::setFontSize(int arg)
@@ -263,7 +307,7 @@ void DocumentHandler::setFontSize(int arg)
     // end up taking effect if the user deletes all the text.
     cursor.mergeBlockCharFormat(format);
 
-    Q_EMIT fontSizeChanged();
+    updateFormat();
 }
 
 int DocumentHandler::defaultFontSize() const
@@ -285,12 +329,7 @@ void DocumentHandler::setDefaultFontSize(int arg)
 
 QColor DocumentHandler::textColor() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return QColor(Qt::black);
-    }
-    QTextCharFormat format = cursor.charFormat();
-    return format.foreground().color();
+    return m_format.textColor;
 }
 
 void DocumentHandler::setTextColor(const QColor &c)
@@ -302,17 +341,12 @@ void DocumentHandler::setTextColor(const QColor &c)
     QTextCharFormat format;
     format.setForeground(QBrush(c));
     mergeFormatOnWordOrSelection(format);
-    Q_EMIT textColorChanged();
+    updateFormat();
 }
 
 QString DocumentHandler::fontFamily() const
 {
-    QTextCursor cursor = textCursor();
-    if (cursor.isNull()) {
-        return QString();
-    }
-    QTextCharFormat format = cursor.charFormat();
-    return format.font().family();
+    return m_format.fontFamily;
 }
 
 void DocumentHandler::setFontFamily(const QString &arg)
@@ -324,7 +358,7 @@ void DocumentHandler::setFontFamily(const QString &arg)
     QTextCharFormat format;
     format.setFontFamily(arg);
     mergeFormatOnWordOrSelection(format);
-    Q_EMIT fontFamilyChanged();
+    updateFormat();
 }
 
 QStringList DocumentHandler::defaultFontSizes() const
@@ -135,8 +135,22 @@ Q_SIGNALS:
     void documentTitleChanged();
 
 private:
+    // the formatting at the cursor or selection as shown in the toolbar
+    struct Format {
+        QString fontFamily;
+        QColor textColor = Qt::black;
+        Qt::Alignment alignment = Qt::AlignLeft;
+        bool bold = false;
+        bool italic = false;
+        bool underline = false;
+        bool strikeOut = false;
+        int fontSize = 0;
+    };
+
     QTextCursor textCursor() const;
     void mergeFormatOnWordOrSelection(const QTextCharFormat &format);
+    void scheduleFormatUpdate();
+    void updateFormat();
 
     QQuickItem *m_target;
     QTextDocument *m_doc;
@@ -145,6 +159,9 @@ private:
     int m_selectionStart;
     int m_selectionEnd;
 
+    Format m_format;
+    bool m_formatUpdateScheduled = false;
+
     QFont m_font;
     int m_fontSize;
     QString m_text;
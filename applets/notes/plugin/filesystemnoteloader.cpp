@@ -9,32 +9,74 @@
 
 #include "note.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QPointer>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QUuid>
 
-#include <KDirWatch>
+// saves are written at most this many ms after the first unwritten one, all of them at once
+static const int WRITE_DELAY = 1000;
+
+static QByteArray contentHash(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
 
 class FileNote : public Note
 {
     Q_OBJECT
 public:
-    FileNote(const QString &path, const QString &id);
+    FileNote(FileSystemNoteLoader *loader, const QString &path, const QString &id);
+    ~FileNote() override;
+    QString path() const;
     void load();
     void save(const QString &text) override;
 
 private:
-    void fileSystemChanged(const QString &path);
+    QPointer<FileSystemNoteLoader> m_loader;
     QString m_path;
-    KDirWatch *m_watcher;
+    // hash of the content last read from or written to the file
+    QByteArray m_hash;
 };
 
-FileSystemNoteLoader::FileSystemNoteLoader()
+static QString notesPath()
 {
     const QString genericDataLocation = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation);
     const QString suffix = QStringLiteral("plasma_notes");
     QDir(genericDataLocation).mkdir(suffix);
-    m_notesDir.setPath(genericDataLocation + QDir::separator() + suffix);
+    return genericDataLocation + QDir::separator() + suffix;
+}
+
+FileSystemNoteLoader::FileSystemNoteLoader()
+    : m_notesDir(notesPath())
+    , m_index(m_notesDir.absolutePath())
+{
+
+    m_watcher.addDir(m_notesDir.absolutePath(), KDirWatch::WatchFiles);
+    connect(&m_watcher, &KDirWatch::created, this, &FileSystemNoteLoader::fileChanged);
+    connect(&m_watcher, &KDirWatch::dirty, this, &FileSystemNoteLoader::fileChanged);
+    connect(&m_watcher, &KDirWatch::deleted, this, &FileSystemNoteLoader::fileChanged);
+
+    m_writeTimer.setSingleShot(true);
+    m_writeTimer.setInterval(WRITE_DELAY);
+    connect(&m_writeTimer, &QTimer::timeout, this, &FileSystemNoteLoader::flush);
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this] {
+            flush();
+            m_writePool.waitForDone();
+        });
+    }
+
+    m_writePool.setMaxThreadCount(1);
+}
+
+FileSystemNoteLoader::~FileSystemNoteLoader()
+{
+    flush();
+    m_writePool.waitForDone();
 }
 
 QStringList FileSystemNoteLoader::allNoteIds()
@@ -44,7 +86,41 @@ QStringList FileSystemNoteLoader::allNoteIds()
 
 void FileSystemNoteLoader::deleteNoteResources(const QString &id)
 {
+    const QString path = m_notesDir.absoluteFilePath(id);
+    // a pending save must not bring the note back
+    m_pendingWrites.remove(path);
+    m_writePool.waitForDone();
+    m_writtenHashes.remove(path);
     m_notesDir.remove(id);
+    indexFile(path);
+}
+
+QVector<NoteIndex::Result> FileSystemNoteLoader::search(const QString &query, int limit)
+{
+    // afterwards the directory watch keeps the index current
+    if (!m_indexUpToDate) {
+        m_indexUpToDate = true;
+        if (m_index.update()) {
+            startWriteTimer();
+        }
+    }
+    return m_index.search(query, limit);
+}
+
+void FileSystemNoteLoader::indexFile(const QString &path)
+{
+    if (m_index.updateFile(path)) {
+        // saved along with the next writes
+        startWriteTimer();
+    }
+}
+
+void FileSystemNoteLoader::startWriteTimer()
+{
+    // further saves must not postpone the write, while typing it would never happen otherwise
+    if (!m_writeTimer.isActive()) {
+        m_writeTimer.start();
+    }
 }
 
 Note *FileSystemNoteLoader::loadNote(const QString &id)
@@ -54,54 +130,127 @@ Note *FileSystemNoteLoader::loadNote(const QString &id)
         idToUse = QUuid::createUuid().toString().mid(1, 34); // UUID adds random braces I don't want them on my file system
     }
 
-    FileNote *note = new FileNote(m_notesDir.absoluteFilePath(idToUse), idToUse);
+    FileNote *note = new FileNote(this, m_notesDir.absoluteFilePath(idToUse), idToUse);
+    m_notes.insert(note->path(), note);
     return note;
 }
 
-FileNote::FileNote(const QString &path, const QString &id)
+void FileSystemNoteLoader::unregisterNote(FileNote *note)
+{
+    m_notes.remove(note->path(), note);
+}
+
+void FileSystemNoteLoader::scheduleWrite(const QString &path, const QByteArray &data)
+{
+    m_pendingWrites.insert(path, data);
+    startWriteTimer();
+}
+
+void FileSystemNoteLoader::flush()
+{
+    m_writeTimer.stop();
+
+    for (auto it = m_pendingWrites.cbegin(), end = m_pendingWrites.cend(); it != end; ++it) {
+        const QString path = it.key();
+        const QByteArray data = it.value();
+        m_writtenHashes[path].append(contentHash(data));
+        ++m_runningWrites[path];
+        m_writePool.start([this, path, data] {
+            // written to a temporary file first, a crash can not leave a truncated note behind
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+                qWarning() << "Could not write notes to file" << path;
+            }
+            QMetaObject::invokeMethod(
+                this,
+                [this, path] {
+                    if (--m_runningWrites[path] == 0) {
+                        m_runningWrites.remove(path);
+                        // the file holds the last write now
+                        QVector<QByteArray> &hashes = m_writtenHashes[path];
+                        hashes.remove(0, hashes.count() - 1);
+                        indexFile(path);
+                    }
+                },
+                Qt::QueuedConnection);
+        });
+    }
+    m_pendingWrites.clear();
+
+    m_index.save();
+}
+
+void FileSystemNoteLoader::fileChanged(const QString &path)
+{
+    // the file is about to be overwritten with what the note shows already
+    if (m_pendingWrites.contains(path)) {
+        return;
+    }
+
+    // one of our own writes, it is indexed once all of them finished
+    const auto writtenHashes = m_writtenHashes.constFind(path);
+    if (writtenHashes != m_writtenHashes.constEnd()) {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly) && writtenHashes->contains(contentHash(file.readAll()))) {
+            return;
+        }
+    }
+
+    indexFile(path);
+
+    const auto notes = m_notes.values(path);
+    for (FileNote *note : notes) {
+        note->load();
+    }
+}
+
+FileNote::FileNote(FileSystemNoteLoader *loader, const QString &path, const QString &id)
     : Note(id)
+    , m_loader(loader)
     , m_path(path)
-    , m_watcher(new KDirWatch(this))
 {
-    m_watcher->addFile(path);
+    load();
+}
 
-    connect(m_watcher, &KDirWatch::created, this, &FileNote::fileSystemChanged);
-    connect(m_watcher, &KDirWatch::dirty, this, &FileNote::fileSystemChanged);
+FileNote::~FileNote()
+{
+    if (m_loader) {
+        m_loader->unregisterNote(this);
+    }
+}
 
-    load();
+QString FileNote::path() const
+{
+    return m_path;
 }
 
 void FileNote::load()
 {
     QFile file(m_path);
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        setNoteText(QString::fromUtf8(file.readAll()));
+        const QByteArray data = file.readAll();
+        const QByteArray hash = contentHash(data);
+        // our own writes come back as change notifications as well
+        if (hash != m_hash) {
+            m_hash = hash;
+            setNoteText(QString::fromUtf8(data));
+        }
     }
 }
 
 void FileNote::save(const QString &text)
 {
-    if (text == noteText()) {
+    const QByteArray data = text.toUtf8();
+    const QByteArray hash = contentHash(data);
+    if (hash == m_hash) {
         return;
     }
 
-    m_watcher->removeFile(m_path);
-
-    QFile file(m_path);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        file.write(text.toUtf8());
-    } else {
-        qWarning() << "Could not write notes to file" << m_path;
-    }
+    m_hash = hash;
     setNoteText(text);
 
-    m_watcher->addFile(m_path);
-}
-
-void FileNote::fileSystemChanged(const QString &path)
-{
-    if (path == m_path) {
-        load();
+    if (m_loader) {
+        m_loader->scheduleWrite(m_path, data);
     }
 }
 
@@ -9,20 +9,73 @@
 #define FILESYSTEMNOTELOADER_H
 
 #include "abstractnoteloader.h"
+#include "noteindex.h"
 
 #include <QDir>
+#include <QHash>
 #include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
 
-class FileSystemNoteLoader : public AbstractNoteLoader
+#include <KDirWatch>
+
+class FileNote;
+
+/**
+ * Stores the notes as text files, shared by all note applets.
+ *
+ * A single directory watch reports external changes to the notes. Saves are
+ * collected for a moment and written atomically on a background thread. The
+ * content of the notes is indexed for searching.
+ */
+class FileSystemNoteLoader : public QObject, public AbstractNoteLoader
 {
+    Q_OBJECT
+
 public:
     explicit FileSystemNoteLoader();
+    ~FileSystemNoteLoader() override;
+
     QStringList allNoteIds() override;
     Note *loadNote(const QString &id) override;
     void deleteNoteResources(const QString &id) override;
+    QVector<NoteIndex::Result> search(const QString &query, int limit) override;
+
+    /**
+     * Writes @p data to @p path a moment after the first unwritten save,
+     * a newer write to the same path replaces a pending one.
+     */
+    void scheduleWrite(const QString &path, const QByteArray &data);
+
+    void unregisterNote(FileNote *note);
+
+public Q_SLOTS:
+    /**
+     * Starts all pending writes right away.
+     */
+    void flush();
 
 private:
+    void fileChanged(const QString &path);
+    void indexFile(const QString &path);
+    void startWriteTimer();
+
     QDir m_notesDir;
+    KDirWatch m_watcher;
+    QMultiHash<QString, FileNote *> m_notes;
+    QHash<QString, QByteArray> m_pendingWrites;
+    // number of writes on the pool per path
+    QHash<QString, int> m_runningWrites;
+    // hashes of the content of the running writes and the last finished one per path,
+    // to recognise our own writes when they are reported
+    QHash<QString, QVector<QByteArray>> m_writtenHashes;
+    QTimer m_writeTimer;
+    // a single thread, so that writes to the same file happen in order
+    QThreadPool m_writePool;
+    NoteIndex m_index;
+    // whether the notes have been compared against the index yet
+    bool m_indexUpToDate = false;
 };
 
 #endif // FILESYSTEMNOTEMANAGER_H
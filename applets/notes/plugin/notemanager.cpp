@@ -32,6 +32,20 @@ void NoteManager::deleteNoteResources(const QString &id)
     m_backend->deleteNoteResources(id);
 }
 
+QVariantList NoteManager::search(const QString &query, int limit)
+{
+    QVariantList results;
+    const auto matches = m_backend->search(query, limit);
+    for (const NoteIndex::Result &match : matches) {
+        results.append(QVariantMap{
+            {QStringLiteral("id"), match.id},
+            {QStringLiteral("title"), match.title},
+            {QStringLiteral("relevance"), match.relevance},
+        });
+    }
+    return results;
+}
+
 QSharedPointer<AbstractNoteLoader> NoteManager::loadBackend()
 {
     static QMutex mutex;
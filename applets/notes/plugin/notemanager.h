@@ -11,6 +11,7 @@
 #include <QObject>
 #include <QPointer>
 #include <QSharedPointer>
+#include <QVariantList>
 
 #include "abstractnoteloader.h"
 class Note;
@@ -33,6 +34,12 @@ public:
      */
     Q_INVOKABLE void deleteNoteResources(const QString &id);
 
+    /**
+     * Searches the content of all notes
+     * Returns a list of objects with the id, title and relevance of each match, best matches first
+     */
+    Q_INVOKABLE QVariantList search(const QString &query, int limit = 20);
+
     // LATER QAbstractListModel* notesModel(); //list of all notes
 
 private:
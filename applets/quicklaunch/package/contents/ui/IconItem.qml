@@ -18,7 +18,10 @@ Item {
     readonly property int itemIndex : index
     property bool dragging : false
     property bool isPopupItem : false
-    readonly property var launcher : logic.launcherData(url)
+    readonly property var launcher : {
+        logic.dataRevision; // re-read once the launcher has been loaded or changed on disk
+        return logic.launcherData(url);
+    }
     readonly property string iconName : launcher.iconName || "fork"
 
     width: isPopupItem ? LayoutManager.popupItemWidth() : grid.cellWidth
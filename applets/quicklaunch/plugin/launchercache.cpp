@@ -0,0 +1,239 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "launchercache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QMimeType>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <KConfigGroup>
+#include <KDesktopFile>
+#include <KDirWatch>
+#include <KFileItem>
+
+#include <kio/global.h>
+
+Q_GLOBAL_STATIC(LauncherCache, s_cache)
+
+LauncherLoader::LauncherLoader(const QVector<Launcher> &launchers)
+    : m_launchers(launchers)
+{
+    setAutoDelete(false);
+}
+
+QVector<LauncherLoader::Launcher> LauncherLoader::launchers() const
+{
+    return m_launchers;
+}
+
+void LauncherLoader::run()
+{
+    for (Launcher &launcher : m_launchers) {
+        if (launcher.url.isLocalFile()) {
+            const QFileInfo fi(launcher.url.toLocalFile());
+            const qint64 lastModified = fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : -1;
+            if (lastModified >= 0 && lastModified == launcher.lastModified) {
+                launcher.unchanged = true;
+                continue;
+            }
+            launcher.lastModified = lastModified;
+        }
+        launcher.data = readLauncherData(launcher.url);
+    }
+
+    Q_EMIT finished();
+}
+
+QVariantMap LauncherLoader::readLauncherData(const QUrl &url)
+{
+    QString name;
+    QString icon;
+    QString genericName;
+    QVariantList jumpListActions;
+
+    if (url.scheme() == QLatin1String("quicklaunch")) {
+        // Ignore internal scheme
+    } else if (url.isLocalFile()) {
+        const KFileItem fileItem(url);
+        const QFileInfo fi(url.toLocalFile());
+
+        if (fileItem.isDesktopFile()) {
+            const KDesktopFile f(url.toLocalFile());
+            name = f.readName();
+            icon = f.readIcon();
+            genericName = f.readGenericName();
+            if (name.isEmpty()) {
+                name = QFileInfo(url.toLocalFile()).fileName();
+            }
+
+            const QStringList &actions = f.readActions();
+
+            for (const QString &actionName : actions) {
+                const KConfigGroup &actionGroup = f.actionGroup(actionName);
+
+                if (!actionGroup.isValid() || !actionGroup.exists()) {
+                    continue;
+                }
+
+                const QString &name = actionGroup.readEntry("Name");
+                const QString &exec = actionGroup.readEntry("Exec");
+                if (name.isEmpty() || exec.isEmpty()) {
+                    continue;
+                }
+
+                jumpListActions << QVariantMap{{QStringLiteral("name"), name},
+                                               {QStringLiteral("icon"), actionGroup.readEntry("Icon")},
+                                               {QStringLiteral("exec"), exec}};
+            }
+        } else {
+            QMimeDatabase db;
+            name = fi.baseName();
+            icon = db.mimeTypeForUrl(url).iconName();
+            genericName = fi.baseName();
+        }
+    } else {
+        name = placeholderName(url);
+        icon = KIO::iconNameForUrl(url);
+    }
+
+    return QVariantMap{{QStringLiteral("applicationName"), name},
+                       {QStringLiteral("iconName"), icon},
+                       {QStringLiteral("genericName"), genericName},
+                       {QStringLiteral("jumpListActions"), jumpListActions}};
+}
+
+QString LauncherLoader::placeholderName(const QUrl &url)
+{
+    if (url.scheme() == QLatin1String("quicklaunch") || url.isLocalFile()) {
+        return QString();
+    }
+
+    if (url.scheme().contains(QLatin1String("http"))) {
+        return url.host();
+    }
+
+    QString name = url.toString();
+    if (name.endsWith(QLatin1String(":/"))) {
+        name = url.scheme();
+    }
+    return name;
+}
+
+LauncherCache::LauncherCache()
+    : m_dirWatch(new KDirWatch(this))
+{
+    connect(m_dirWatch, &KDirWatch::dirty, this, &LauncherCache::directoryChanged);
+}
+
+LauncherCache::~LauncherCache()
+{
+    // a running loader deletes itself once it is done
+    if (m_loader) {
+        m_loader->disconnect(this);
+    }
+}
+
+LauncherCache *LauncherCache::self()
+{
+    return s_cache();
+}
+
+QVariantMap LauncherCache::launcherData(const QUrl &url)
+{
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        Entry entry;
+        // everything but the name of remote urls needs the disk
+        entry.data = QVariantMap{{QStringLiteral("applicationName"), LauncherLoader::placeholderName(url)},
+                                 {QStringLiteral("iconName"), QString()},
+                                 {QStringLiteral("genericName"), QString()},
+                                 {QStringLiteral("jumpListActions"), QVariantList()}};
+        it = m_entries.insert(url, entry);
+        queue(url);
+    }
+    return it->data;
+}
+
+void LauncherCache::queue(const QUrl &url)
+{
+    m_queue.insert(url);
+    // collect all launchers of a (re)loading applet into one batch
+    if (!m_loader) {
+        QTimer::singleShot(0, this, &LauncherCache::startLoading);
+    }
+}
+
+void LauncherCache::startLoading()
+{
+    if (m_loader || m_queue.isEmpty()) {
+        return;
+    }
+
+    QVector<LauncherLoader::Launcher> launchers;
+    launchers.reserve(m_queue.count());
+    for (const QUrl &url : qAsConst(m_queue)) {
+        const Entry &entry = m_entries[url];
+        LauncherLoader::Launcher launcher;
+        launcher.url = url;
+        launcher.lastModified = entry.loaded ? entry.lastModified : -1;
+        launchers.append(launcher);
+    }
+    m_queue.clear();
+
+    m_loader = new LauncherLoader(launchers);
+    connect(m_loader, &LauncherLoader::finished, this, &LauncherCache::loaderFinished);
+    connect(m_loader, &LauncherLoader::finished, m_loader, &QObject::deleteLater);
+    QThreadPool::globalInstance()->start(m_loader);
+}
+
+void LauncherCache::loaderFinished()
+{
+    const QVector<LauncherLoader::Launcher> launchers = m_loader->launchers();
+    m_loader = nullptr;
+
+    bool changed = false;
+    for (const LauncherLoader::Launcher &launcher : launchers) {
+        if (launcher.url.isLocalFile()) {
+            const QString dir = QFileInfo(launcher.url.toLocalFile()).absolutePath();
+            if (!m_watchedDirs.contains(dir)) {
+                m_watchedDirs.insert(dir);
+                m_dirWatch->addDir(dir);
+            }
+        }
+
+        if (launcher.unchanged) {
+            continue;
+        }
+
+        Entry &entry = m_entries[launcher.url];
+        entry.lastModified = launcher.lastModified;
+        entry.loaded = true;
+        if (entry.data != launcher.data) {
+            entry.data = launcher.data;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        Q_EMIT this->changed();
+    }
+
+    startLoading();
+}
+
+void LauncherCache::directoryChanged(const QString &path)
+{
+    // the modification times tell which of the launchers really changed
+    for (auto it = m_entries.cbegin(), end = m_entries.cend(); it != end; ++it) {
+        if (it.key().isLocalFile() && QFileInfo(it.key().toLocalFile()).absolutePath() == path) {
+            queue(it.key());
+        }
+    }
+}
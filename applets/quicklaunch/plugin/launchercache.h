@@ -0,0 +1,110 @@
+/*
+ *  SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef LAUNCHERCACHE_H
+#define LAUNCHERCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+#include <QUrl>
+#include <QVariantMap>
+#include <QVector>
+
+class KDirWatch;
+
+/**
+ * Reads the name, icon and actions of launchers on a worker thread.
+ *
+ * Launchers whose modification time still matches the known one are
+ * reported as unchanged without being read again.
+ */
+class LauncherLoader : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    struct Launcher {
+        QUrl url;
+        // ms since epoch, -1 if unknown or not a local file
+        qint64 lastModified = -1;
+        QVariantMap data;
+        bool unchanged = false;
+    };
+
+    explicit LauncherLoader(const QVector<Launcher> &launchers);
+
+    void run() override;
+
+    /**
+     * The loaded launchers, valid after finished().
+     */
+    QVector<Launcher> launchers() const;
+
+    /**
+     * Reads the data of the launcher @p url, this does disk I/O.
+     */
+    static QVariantMap readLauncherData(const QUrl &url);
+
+    /**
+     * Returns the name of the launcher @p url as far as it is known without disk I/O.
+     */
+    static QString placeholderName(const QUrl &url);
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    QVector<Launcher> m_launchers;
+};
+
+/**
+ * Launcher data shared by all Quicklaunch applets of the process.
+ *
+ * Unknown launchers are loaded asynchronously, until then a placeholder
+ * is returned. The directories of local launchers are watched and changed
+ * launchers are loaded again.
+ */
+class LauncherCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    LauncherCache();
+    ~LauncherCache() override;
+
+    static LauncherCache *self();
+
+    /**
+     * Returns the data of the launcher @p url without blocking on the disk.
+     * changed() is emitted once data which was not known yet has been loaded.
+     */
+    QVariantMap launcherData(const QUrl &url);
+
+Q_SIGNALS:
+    void changed();
+
+private:
+    void queue(const QUrl &url);
+    void startLoading();
+    void loaderFinished();
+    void directoryChanged(const QString &path);
+
+    struct Entry {
+        qint64 lastModified = -1;
+        QVariantMap data;
+        bool loaded = false;
+    };
+
+    QHash<QUrl, Entry> m_entries;
+    QSet<QUrl> m_queue;
+    LauncherLoader *m_loader = nullptr;
+    KDirWatch *m_dirWatch = nullptr;
+    QSet<QString> m_watchedDirs;
+};
+
+#endif // LAUNCHERCACHE_H
@@ -8,94 +8,39 @@
  */
 
 #include "quicklaunch_p.h"
+#include "launchercache.h"
 
 #include <QDir>
 #include <QFileInfo>
-#include <QMimeDatabase>
-#include <QMimeType>
 #include <QRandomGenerator>
 #include <QStandardPaths>
 
 #include <KConfig>
 #include <KConfigGroup>
 #include <KDesktopFile>
-#include <KFileItem>
 #include <KIO/CommandLauncherJob>
 #include <KNotificationJobUiDelegate>
 #include <KOpenWithDialog>
 #include <KPropertiesDialog>
 #include <KRun>
 
-#include <kio/global.h>
-
 QuicklaunchPrivate::QuicklaunchPrivate(QObject *parent)
     : QObject(parent)
 {
+    connect(LauncherCache::self(), &LauncherCache::changed, this, [this]() {
+        ++m_dataRevision;
+        Q_EMIT dataRevisionChanged();
+    });
 }
 
 QVariantMap QuicklaunchPrivate::launcherData(const QUrl &url)
 {
-    QString name;
-    QString icon;
-    QString genericName;
-    QVariantList jumpListActions;
-
-    if (url.scheme() == QLatin1String("quicklaunch")) {
-        // Ignore internal scheme
-    } else if (url.isLocalFile()) {
-        const KFileItem fileItem(url);
-        const QFileInfo fi(url.toLocalFile());
-
-        if (fileItem.isDesktopFile()) {
-            const KDesktopFile f(url.toLocalFile());
-            name = f.readName();
-            icon = f.readIcon();
-            genericName = f.readGenericName();
-            if (name.isEmpty()) {
-                name = QFileInfo(url.toLocalFile()).fileName();
-            }
-
-            const QStringList &actions = f.readActions();
-
-            for (const QString &actionName : actions) {
-                const KConfigGroup &actionGroup = f.actionGroup(actionName);
-
-                if (!actionGroup.isValid() || !actionGroup.exists()) {
-                    continue;
-                }
-
-                const QString &name = actionGroup.readEntry("Name");
-                const QString &exec = actionGroup.readEntry("Exec");
-                if (name.isEmpty() || exec.isEmpty()) {
-                    continue;
-                }
-
-                jumpListActions << QVariantMap{{QStringLiteral("name"), name},
-                                               {QStringLiteral("icon"), actionGroup.readEntry("Icon")},
-                                               {QStringLiteral("exec"), exec}};
-            }
-        } else {
-            QMimeDatabase db;
-            name = fi.baseName();
-            icon = db.mimeTypeForUrl(url).iconName();
-            genericName = fi.baseName();
-        }
-    } else {
-        if (url.scheme().contains(QLatin1String("http"))) {
-            name = url.host();
-        } else if (name.isEmpty()) {
-            name = url.toString();
-            if (name.endsWith(QLatin1String(":/"))) {
-                name = url.scheme();
-            }
-        }
-        icon = KIO::iconNameForUrl(url);
-    }
+    return LauncherCache::self()->launcherData(url);
+}
 
-    return QVariantMap{{QStringLiteral("applicationName"), name},
-                       {QStringLiteral("iconName"), icon},
-                       {QStringLiteral("genericName"), genericName},
-                       {QStringLiteral("jumpListActions"), jumpListActions}};
+int QuicklaunchPrivate::dataRevision() const
+{
+    return m_dataRevision;
 }
 
 void QuicklaunchPrivate::openUrl(const QUrl &url)
@@ -168,7 +113,7 @@ void QuicklaunchPrivate::editLauncher(QUrl url, int index, bool isPopup)
 
     if (!url.isLocalFile() || !KDesktopFile::isDesktopFile(url.toLocalFile())) {
         const QString desktopFilePath = determineNewDesktopFilePath(QStringLiteral("launcher"));
-        const QVariantMap data = launcherData(url);
+        const QVariantMap data = LauncherLoader::readLauncherData(url);
 
         KConfig desktopFile(desktopFilePath);
         KConfigGroup desktopEntry(&desktopFile, "Desktop Entry");
@@ -15,9 +15,19 @@ class QuicklaunchPrivate : public QObject
 {
     Q_OBJECT
 
+    /**
+     * Increases whenever loading finished for launchers, launcherData() should be queried again then.
+     */
+    Q_PROPERTY(int dataRevision READ dataRevision NOTIFY dataRevisionChanged)
+
 public:
     explicit QuicklaunchPrivate(QObject *parent = nullptr);
 
+    int dataRevision() const;
+
+    /**
+     * Returns the cached data of the launcher @p url, or a placeholder while it is loaded.
+     */
     Q_INVOKABLE QVariantMap launcherData(const QUrl &url);
     Q_INVOKABLE void openUrl(const QUrl &url);
     Q_INVOKABLE void openExec(const QString &exec);
@@ -26,8 +36,12 @@ public:
     Q_INVOKABLE void editLauncher(QUrl url, int index, bool isPopup = false);
 
 Q_SIGNALS:
+    void dataRevisionChanged();
     void launcherAdded(const QString &url, bool isPopup);
     void launcherEdited(const QString &url, int index, bool isPopup);
+
+private:
+    int m_dataRevision = 0;
 };
 
 #endif // QUICKLAUNCH_P_H
@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "weatherprotocol.h"
+
+#include <QTest>
+
+using namespace WeatherProtocol;
+
+class WeatherProtocolTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testTokenizer();
+    void testIon();
+    void testStation();
+    void testValidPlaces();
+    void testInvalid();
+    void testTimeout();
+    void benchmarkValidation();
+};
+
+void WeatherProtocolTest::testTokenizer()
+{
+    Tokenizer tokenizer(u"a||b|");
+    QCOMPARE(tokenizer.next().toString(), QStringLiteral("a"));
+    QCOMPARE(tokenizer.next().toString(), QStringLiteral(""));
+    QCOMPARE(tokenizer.peek().toString(), QStringLiteral("b"));
+    QCOMPARE(tokenizer.next().toString(), QStringLiteral("b"));
+    QVERIFY(!tokenizer.atEnd());
+    QCOMPARE(tokenizer.next().toString(), QStringLiteral(""));
+    QVERIFY(tokenizer.atEnd());
+}
+
+void WeatherProtocolTest::testIon()
+{
+    Ion ion;
+    QVERIFY(Ion::parse(u"BBC Weather|bbcukmet", &ion));
+    QCOMPARE(ion.displayName.toString(), QStringLiteral("BBC Weather"));
+    QCOMPARE(ion.id.toString(), QStringLiteral("bbcukmet"));
+
+    QVERIFY(!Ion::parse(u"bbcukmet", &ion));
+}
+
+void WeatherProtocolTest::testStation()
+{
+    Station station;
+    QVERIFY(Station::parse(u"bbcukmet|weather|London, Greater London|2643743", &station));
+    QCOMPARE(station.ion.toString(), QStringLiteral("bbcukmet"));
+    QCOMPARE(station.name.toString(), QStringLiteral("London, Greater London"));
+    QCOMPARE(station.extra.toString(), QStringLiteral("2643743"));
+
+    QVERIFY(Station::parse(u"noaa|weather|Seattle", &station));
+    QCOMPARE(station.name.toString(), QStringLiteral("Seattle"));
+    QVERIFY(station.extra.isEmpty());
+
+    QVERIFY(!Station::parse(u"noaa|weather", &station));
+}
+
+void WeatherProtocolTest::testValidPlaces()
+{
+    ValidationReader reader(u"bbcukmet|valid|multiple|place|London, Greater London|extra|2643743|place|London, Ontario|place|Londonderry|extra");
+    QVERIFY(reader.hasStatus());
+    QVERIFY(reader.isValid());
+    QCOMPARE(reader.ion().toString(), QStringLiteral("bbcukmet"));
+
+    Place place;
+    QVERIFY(reader.nextPlace(&place));
+    QCOMPARE(place.name.toString(), QStringLiteral("London, Greater London"));
+    QCOMPARE(place.extra.toString(), QStringLiteral("2643743"));
+    QVERIFY(reader.nextPlace(&place));
+    QCOMPARE(place.name.toString(), QStringLiteral("London, Ontario"));
+    QVERIFY(place.extra.isEmpty());
+    QVERIFY(reader.nextPlace(&place));
+    QCOMPARE(place.name.toString(), QStringLiteral("Londonderry"));
+    QVERIFY(place.extra.isEmpty());
+    QVERIFY(!reader.nextPlace(&place));
+}
+
+void WeatherProtocolTest::testInvalid()
+{
+    ValidationReader reader(u"envcan|invalid|single|Atlantis");
+    QVERIFY(reader.hasStatus());
+    QVERIFY(!reader.isValid());
+    QVERIFY(!reader.isTimeout());
+    QCOMPARE(reader.searchTerm().toString(), QStringLiteral("Atlantis"));
+
+    Place place;
+    QVERIFY(!reader.nextPlace(&place));
+
+    QVERIFY(!ValidationReader(u"garbage").hasStatus());
+}
+
+void WeatherProtocolTest::testTimeout()
+{
+    ValidationReader reader(u"envcan|timeout");
+    QVERIFY(reader.hasStatus());
+    QVERIFY(reader.isTimeout());
+}
+
+void WeatherProtocolTest::benchmarkValidation()
+{
+    QString data = QStringLiteral("bbcukmet|valid|multiple");
+    for (int i = 0; i < 500; ++i) {
+        data += QStringLiteral("|place|Place %1, Some County, Some Country|extra|%2").arg(i).arg(1000000 + i);
+    }
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        ValidationReader reader(data);
+        Place place;
+        while (reader.nextPlace(&place)) {
+            ++count;
+        }
+    }
+    QCOMPARE(count, 500);
+}
+
+QTEST_GUILESS_MAIN(WeatherProtocolTest)
+
+#include "weatherprotocoltest.moc"
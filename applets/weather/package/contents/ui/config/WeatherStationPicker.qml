@@ -82,16 +82,9 @@ ColumnLayout {
             focus: true
             placeholderText: i18nc("@info:placeholder", "Enter location")
 
-            Timer {
-                id: searchDelayTimer
-                interval: 500
-                onTriggered: {
-                    searchLocation();
-                }
-            }
-
+            // the model waits for the typing to stop before it searches
             onTextChanged: {
-                searchDelayTimer.restart();
+                searchLocation();
             }
 
             Keys.onPressed: {
@@ -5,6 +5,7 @@
  */
 
 import QtQuick 2.9
+import QtQuick.Window 2.2
 
 import org.kde.plasma.plasmoid 2.0
 import org.kde.plasma.core 2.0 as PlasmaCore
@@ -24,6 +25,9 @@ Item {
     readonly property int displayVisibilityUnit: plasmoid.nativeInterface.displayVisibilityUnit
 
     property bool connectingToSource: false
+    // whether a representation is on screen, the root item stays visible while the popup is collapsed
+    property bool compactShown: false
+    property bool fullShown: false
     readonly property bool needsConfiguration: !generalModel.location && !connectingToSource
 
     readonly property int invalidUnit: -1 //TODO: make KUnitConversion::InvalidUnit usable here
@@ -233,8 +237,8 @@ Item {
 
         var dayItems = [];
         var conditionItems = [];
-        var hiItems = [];
-        var lowItems = [];
+        var hiValues = [];
+        var lowValues = [];
 
         for (var i = 0; i < forecastDayCount; ++i) {
             var forecastDayKey = "Short Forecast Day " + i;
@@ -267,27 +271,25 @@ Item {
                 conditionItems.push(iconAndToolTip);
             }
 
+            // "N/A" is formatted as empty string
             var tempHigh = forecastDayTokens[3];
             if (tempHigh !== "N/U") {
-                if (tempHigh === "N/A" || !tempHigh) {
-                    hiItems.push(i18nc("Short for no data available", "-"));
-                } else {
-                    hiItems.push(Util.temperatureToDisplayString(displayTemperatureUnit, tempHigh,
-                                                                 reportTemperatureUnit, true));
-                }
+                hiValues.push(tempHigh);
             }
 
             var tempLow = forecastDayTokens[4];
             if (tempLow !== "N/U") {
-                if (tempLow === "N/A" || !tempLow) {
-                    lowItems.push(i18nc("Short for no data available", "-"));
-                } else {
-                    lowItems.push(Util.temperatureToDisplayString(displayTemperatureUnit, tempLow,
-                                                                  reportTemperatureUnit, true));
-                }
+                lowValues.push(tempLow);
             }
         }
 
+        // all temperatures are formatted in one call
+        var noData = i18nc("Short for no data available", "-");
+        var hiItems = Util.temperaturesToDisplayStrings(displayTemperatureUnit, hiValues, reportTemperatureUnit, true)
+            .map(function(text) { return text || noData; });
+        var lowItems = Util.temperaturesToDisplayStrings(displayTemperatureUnit, lowValues, reportTemperatureUnit, true)
+            .map(function(text) { return text || noData; });
+
         if (dayItems.length) {
             model.push(dayItems);
         }
@@ -337,16 +339,15 @@ Item {
         return model;
     }
 
-    PlasmaCore.DataSource {
+    WeatherSource {
         id: weatherDataSource
 
-        readonly property var currentData: data[weatherSource]
-
-        engine: "weather"
-        connectedSources: weatherSource
+        source: weatherSource
         interval: updateInterval * 60 * 1000
-        onConnectedSourcesChanged: {
-            if (weatherSource) {
+        // poll less often while nobody can see the applet
+        active: root.compactShown || root.fullShown
+        onSourceChanged: {
+            if (weatherSource && !currentData) {
                 connectingToSource = true;
                 plasmoid.busy = true;
                 connectionTimeoutTimer.start();
@@ -423,11 +424,22 @@ Item {
     Plasmoid.compactRepresentation: CompactRepresentation {
         generalModel: root.generalModel
         observationModel: root.observationModel
+
+        readonly property bool shown: visible && Window.visibility !== Window.Hidden
+        onShownChanged: root.compactShown = shown
+        Component.onCompleted: root.compactShown = shown
+        Component.onDestruction: root.compactShown = false
     }
 
     Plasmoid.fullRepresentation: FullRepresentation {
         generalModel: root.generalModel
         observationModel: root.observationModel
+
+        // in a popup the window is hidden while the applet is collapsed
+        readonly property bool shown: visible && Window.visibility !== Window.Hidden
+        onShownChanged: root.fullShown = shown
+        Component.onCompleted: root.fullShown = shown
+        Component.onDestruction: root.fullShown = false
     }
 
     Binding {
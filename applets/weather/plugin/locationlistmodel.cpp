@@ -6,13 +6,27 @@
  */
 
 #include "locationlistmodel.h"
+#include "weatherprotocol.h"
 
 #include <Plasma/DataContainer>
 
 #include <KLocalizedString>
 
+#include <QCache>
 #include <QDebug>
 
+// ms to wait for further input before a search is started
+static const int SEARCH_DELAY = 500;
+// number of search results kept per weather service and search string
+static const int MAX_CACHED_SEARCHES = 50;
+
+// shared between all models, so searches are not repeated when the config dialog is opened again
+static QCache<QString, QVector<LocationItem>> &searchCache()
+{
+    static QCache<QString, QVector<LocationItem>> cache(MAX_CACHED_SEARCHES);
+    return cache;
+}
+
 WeatherValidator::WeatherValidator(Plasma::DataEngine *weatherDataengine, const QString &ionName, QObject *parent)
     : QObject(parent)
     , m_weatherDataEngine(weatherDataengine)
@@ -20,13 +34,25 @@ WeatherValidator::WeatherValidator(Plasma::DataEngine *weatherDataengine, const
 {
 }
 
-WeatherValidator::~WeatherValidator() = default;
+WeatherValidator::~WeatherValidator()
+{
+    // the result of a superseded search is not needed anymore
+    if (!m_validationSource.isEmpty()) {
+        m_weatherDataEngine->disconnectSource(m_validationSource, this);
+    }
+}
 
 void WeatherValidator::validate(const QString &location)
 {
-    const QString validationSource = m_ionName + QLatin1String("|validate|") + location;
+    m_validationSource = m_ionName + QLatin1String("|validate|") + location;
+    m_timedOut = false;
+
+    m_weatherDataEngine->connectSource(m_validationSource, this);
+}
 
-    m_weatherDataEngine->connectSource(validationSource, this);
+bool WeatherValidator::hasTimedOut() const
+{
+    return m_timedOut;
 }
 
 void WeatherValidator::dataUpdated(const QString &source, const Plasma::DataEngine::Data &data)
@@ -34,38 +60,32 @@ void WeatherValidator::dataUpdated(const QString &source, const Plasma::DataEngi
     QMap<QString, QString> locationSources;
 
     m_weatherDataEngine->disconnectSource(source, this);
+    m_validationSource.clear();
 
-    const auto validationResult = data[QStringLiteral("validate")].toString().split(QLatin1Char('|'));
+    const QString validationResult = data[QStringLiteral("validate")].toString();
+    WeatherProtocol::ValidationReader reader(validationResult);
 
-    if (validationResult.size() < 2) {
+    if (!reader.hasStatus()) {
         Q_EMIT error(i18n("Cannot find '%1' using %2.", source, m_ionName));
-    } else if (validationResult[1] == QLatin1String("valid") && validationResult.size() > 2) {
-        const QString weatherSourcePrefix = validationResult[0] + QLatin1String("|weather|");
-        int i = 3;
-
-        const int lastFieldIndex = validationResult.size() - 1;
-        while (i < lastFieldIndex) {
-            if (validationResult[i] == QLatin1String("place")) {
-                const QString &name = validationResult[i + 1];
-                QString locationSource;
-                if (i + 2 < lastFieldIndex && validationResult[i + 2] == QLatin1String("extra")) {
-                    const QString &id = validationResult[i + 3];
-                    locationSource = weatherSourcePrefix + name + QLatin1Char('|') + id;
-                    i += 4;
-                } else {
-                    locationSource = weatherSourcePrefix + name;
-                    i += 2;
-                }
-                locationSources.insert(name, locationSource);
-            } else {
-                ++i;
+    } else if (reader.isValid()) {
+        const QString weatherSourcePrefix = reader.ion().toString() + QLatin1String("|weather|");
+
+        WeatherProtocol::Place place;
+        while (reader.nextPlace(&place)) {
+            const QString name = place.name.toString();
+            QString locationSource = weatherSourcePrefix + name;
+            if (!place.extra.isEmpty()) {
+                locationSource += QLatin1Char('|');
+                locationSource.append(place.extra.data(), place.extra.size());
             }
+            locationSources.insert(name, locationSource);
         }
 
-    } else if (validationResult[1] == QLatin1String("timeout")) {
+    } else if (reader.isTimeout()) {
+        m_timedOut = true;
         Q_EMIT error(i18n("Connection to %1 weather server timed out.", m_ionName));
     } else {
-        const QString searchTerm = validationResult.size() > 3 ? validationResult[3] : source;
+        const QString searchTerm = reader.searchTerm().isEmpty() ? source : reader.searchTerm().toString();
         Q_EMIT error(i18n("Cannot find '%1' using %2.", searchTerm, m_ionName));
     }
 
@@ -75,8 +95,10 @@ void WeatherValidator::dataUpdated(const QString &source, const Plasma::DataEngi
 LocationListModel::LocationListModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_validatingInput(false)
-    , m_checkedInCount(0)
 {
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(SEARCH_DELAY);
+    connect(&m_searchTimer, &QTimer::timeout, this, &LocationListModel::startSearch);
 }
 
 QVariant LocationListModel::data(const QModelIndex &index, int role) const
@@ -130,24 +152,41 @@ QString LocationListModel::nameForListIndex(int listIndex) const
 
 void LocationListModel::searchLocations(const QString &searchString, const QStringList &services)
 {
-    m_checkedInCount = 0;
-
-    // reset current validators
-    qDeleteAll(m_validators);
-    m_validators.clear();
-
     m_searchString = searchString;
+    m_services = services;
 
     if (!m_validatingInput) {
         m_validatingInput = true;
         Q_EMIT validatingInputChanged(true);
     }
 
-    beginResetModel();
-    m_locations.clear();
-    endResetModel();
-
     if (searchString.isEmpty()) {
+        m_searchTimer.stop();
+        startSearch();
+        return;
+    }
+
+    // only search once the user stopped typing
+    m_searchTimer.start();
+}
+
+void LocationListModel::cancelSearch()
+{
+    qDeleteAll(m_validators);
+    m_validators.clear();
+}
+
+void LocationListModel::startSearch()
+{
+    cancelSearch();
+
+    if (!m_locations.isEmpty()) {
+        beginRemoveRows(QModelIndex(), 0, m_locations.count() - 1);
+        m_locations.clear();
+        endRemoveRows();
+    }
+
+    if (m_searchString.isEmpty()) {
         completeSearch();
         return;
     }
@@ -156,24 +195,39 @@ void LocationListModel::searchLocations(const QString &searchString, const QStri
 
     const QVariantList plugins = dataengine->containerForSource(QStringLiteral("ions"))->data().values();
     for (const QVariant &plugin : plugins) {
-        const QStringList pluginInfo = plugin.toString().split(QLatin1Char('|'));
-        if (pluginInfo.count() > 1) {
-            const QString &ionId = pluginInfo[1];
-            if (!services.contains(ionId)) {
+        const QString pluginInfo = plugin.toString();
+        WeatherProtocol::Ion ion;
+        if (WeatherProtocol::Ion::parse(pluginInfo, &ion)) {
+            const QString ionId = ion.id.toString();
+            if (!m_services.contains(ionId)) {
+                continue;
+            }
+            // qDebug() << "ion: " << ion.displayName << ion.id;
+
+            const QString cacheKey = ionId + QLatin1Char('|') + m_searchString;
+            if (const QVector<LocationItem> *locations = searchCache().object(cacheKey)) {
+                addLocations(*locations);
                 continue;
             }
-            // qDebug() << "ion: " << pluginInfo[0] << pluginInfo[1];
-            // d->ions.insert(pluginInfo[1], pluginInfo[0]);
 
             auto *validator = new WeatherValidator(dataengine, ionId, this);
             connect(validator, &WeatherValidator::error, this, &LocationListModel::validatorError);
-            connect(validator, &WeatherValidator::finished, this, &LocationListModel::addSources);
+            connect(validator, &WeatherValidator::finished, this, [this, validator, cacheKey](const QMap<QString, QString> &sources) {
+                validationFinished(validator, cacheKey, sources);
+            });
 
             m_validators.append(validator);
         }
     }
 
-    for (auto *validator : qAsConst(m_validators)) {
+    if (m_validators.isEmpty()) {
+        completeSearch();
+        return;
+    }
+
+    // the data engine might answer right away, which modifies m_validators
+    const auto validators = m_validators;
+    for (auto *validator : validators) {
         validator->validate(m_searchString);
     }
 }
@@ -183,30 +237,42 @@ void LocationListModel::validatorError(const QString &error)
     qDebug() << error;
 }
 
-void LocationListModel::addSources(const QMap<QString, QString> &sources)
+void LocationListModel::validationFinished(WeatherValidator *validator, const QString &cacheKey, const QMap<QString, QString> &sources)
 {
-    QMapIterator<QString, QString> it(sources);
-
-    // TODO: be more elaborate and use beginInsertRows() & endInsertRows()
-    beginResetModel();
-
-    while (it.hasNext()) {
-        it.next();
-        const QStringList list = it.value().split(QLatin1Char('|'), Qt::SkipEmptyParts);
-        if (list.count() > 2) {
-            qDebug() << list;
-            m_locations.append(LocationItem(list[2], list[0], it.value()));
+    QVector<LocationItem> locations;
+    for (auto it = sources.cbegin(), end = sources.cend(); it != end; ++it) {
+        WeatherProtocol::Station station;
+        if (WeatherProtocol::Station::parse(it.value(), &station)) {
+            locations.append(LocationItem(station.name.toString(), station.ion.toString(), it.value()));
         }
     }
 
-    endResetModel();
+    // a timeout is worth another try later
+    if (!validator->hasTimedOut()) {
+        searchCache().insert(cacheKey, new QVector<LocationItem>(locations));
+    }
+
+    m_validators.removeOne(validator);
+    validator->deleteLater();
+
+    addLocations(locations);
 
-    ++m_checkedInCount;
-    if (m_checkedInCount >= m_validators.count()) {
+    if (m_validators.isEmpty()) {
         completeSearch();
     }
 }
 
+void LocationListModel::addLocations(const QVector<LocationItem> &locations)
+{
+    if (locations.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_locations.count(), m_locations.count() + locations.count() - 1);
+    m_locations.append(locations);
+    endInsertRows();
+}
+
 void LocationListModel::completeSearch()
 {
     m_validatingInput = false;
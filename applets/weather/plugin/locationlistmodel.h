@@ -12,6 +12,7 @@
 
 #include <QAbstractListModel>
 #include <QMap>
+#include <QTimer>
 #include <QVector>
 
 class WeatherValidator : public QObject
@@ -26,6 +27,11 @@ public:
      */
     void validate(const QString &location);
 
+    /**
+     * Returns true if the last validation failed because the server did not answer in time
+     */
+    bool hasTimedOut() const;
+
 Q_SIGNALS:
     /**
      * Emitted when an error in validation occurs
@@ -44,6 +50,9 @@ public Q_SLOTS: // callback for the weather dataengine
 private:
     Plasma::DataEngine *m_weatherDataEngine;
     QString m_ionName;
+    // the validation in progress, if any
+    QString m_validationSource;
+    bool m_timedOut = false;
 };
 
 class LocationItem
@@ -85,6 +94,10 @@ public:
 public:
     Q_INVOKABLE QString nameForListIndex(int listIndex) const;
     Q_INVOKABLE QString valueForListIndex(int listIndex) const;
+    /**
+     * Searches @p searchString with the weather @p services once no further
+     * search was requested for a moment, replacing the current search.
+     */
     Q_INVOKABLE void searchLocations(const QString &searchString, const QStringList &services);
 
 Q_SIGNALS:
@@ -92,7 +105,10 @@ Q_SIGNALS:
     void locationSearchDone(bool success, const QString &searchString);
 
 private:
-    void addSources(const QMap<QString, QString> &sources);
+    void startSearch();
+    void cancelSearch();
+    void validationFinished(WeatherValidator *validator, const QString &cacheKey, const QMap<QString, QString> &sources);
+    void addLocations(const QVector<LocationItem> &locations);
     void validatorError(const QString &error);
     void completeSearch();
 
@@ -101,7 +117,9 @@ private:
 
     bool m_validatingInput;
     QString m_searchString;
-    int m_checkedInCount;
+    QStringList m_services;
+    QTimer m_searchTimer;
+    // validators of the current search which have not finished yet
     QVector<WeatherValidator *> m_validators;
 };
 
@@ -10,6 +10,7 @@
 #include "locationlistmodel.h"
 #include "servicelistmodel.h"
 #include "util.h"
+#include "weathersource.h"
 
 // KF
 #include <KLocalizedString>
@@ -78,5 +79,6 @@ void WeatherPlugin::registerTypes(const char *uri)
     qmlRegisterSingletonType<AbstractUnitListModel>(uri, 1, 0, "VisibilityUnitListModel", visibilityUnitListModelSingletonTypeProvider);
     qmlRegisterSingletonType<Util>(uri, 1, 0, "Util", utilSingletonTypeProvider);
     qmlRegisterType<LocationListModel>(uri, 1, 0, "LocationListModel");
+    qmlRegisterType<WeatherSource>(uri, 1, 0, "WeatherSource");
     qmlRegisterType<ServiceListModel>(uri, 1, 0, "ServiceListModel");
 }
@@ -5,6 +5,7 @@
  */
 
 #include "servicelistmodel.h"
+#include "weatherprotocol.h"
 
 #include <Plasma/DataContainer>
 #include <Plasma/DataEngine>
@@ -18,9 +19,10 @@ ServiceListModel::ServiceListModel(QObject *parent)
 
     const QVariantList plugins = dataengine->containerForSource(QLatin1String("ions"))->data().values();
     for (const QVariant &plugin : plugins) {
-        const QStringList pluginInfo = plugin.toString().split(QLatin1Char('|'));
-        if (pluginInfo.count() > 1) {
-            m_services.append(ServiceItem(pluginInfo[0], pluginInfo[1]));
+        const QString pluginInfo = plugin.toString();
+        WeatherProtocol::Ion ion;
+        if (WeatherProtocol::Ion::parse(pluginInfo, &ion)) {
+            m_services.append(ServiceItem(ion.displayName.toString(), ion.id.toString()));
         }
     }
 }
@@ -35,36 +35,108 @@ QString Util::existingWeatherIconName(const QString &iconName) const
     return isValid ? iconName : QStringLiteral("weather-not-available");
 }
 
-QString Util::temperatureToDisplayString(int displayUnitType, double value, int valueUnitType, bool rounded, bool degreesOnly) const
+// the translated patterns only need to be looked up once, the values are filled in with QString::arg()
+static QString temperaturePattern()
+{
+    static const QString pattern = i18nc("temperature unitsymbol", "%1 %2", QStringLiteral("%1"), QStringLiteral("%2"));
+    return pattern;
+}
+
+static QString valuePattern()
+{
+    static const QString pattern = i18nc("value unitsymbol", "%1 %2", QStringLiteral("%1"), QStringLiteral("%2"));
+    return pattern;
+}
+
+const Util::Conversion &Util::conversion(int displayUnitType, int valueUnitType) const
 {
+    const auto key = qMakePair(displayUnitType, valueUnitType);
+    auto it = m_conversions.constFind(key);
+    if (it == m_conversions.constEnd()) {
+        const auto valueUnit = static_cast<KUnitConversion::UnitId>(valueUnitType);
+        const auto displayUnit = static_cast<KUnitConversion::UnitId>(displayUnitType);
+
+        // Most weather units convert linearly, so two points define the whole conversion.
+        // A third point tells the others apart, e.g. Beaufort.
+        const KUnitConversion::Value zero = KUnitConversion::Value(0.0, valueUnit).convertTo(displayUnit);
+        const double one = KUnitConversion::Value(1.0, valueUnit).convertTo(displayUnit).number();
+        const double hundred = KUnitConversion::Value(100.0, valueUnit).convertTo(displayUnit).number();
+
+        Conversion conversion;
+        conversion.factor = one - zero.number();
+        conversion.offset = zero.number();
+        conversion.linear = zero.isValid() && qAbs(conversion.offset + 100 * conversion.factor - hundred) <= 1e-9 * qMax(1.0, qAbs(hundred));
+        conversion.symbol = zero.unit().symbol();
+        it = m_conversions.insert(key, conversion);
+    }
+    return *it;
+}
+
+double Util::convert(const Conversion &conversion, double value, int displayUnitType, int valueUnitType) const
+{
+    if (conversion.linear) {
+        return value * conversion.factor + conversion.offset;
+    }
+
     KUnitConversion::Value v(value, static_cast<KUnitConversion::UnitId>(valueUnitType));
-    v = v.convertTo(static_cast<KUnitConversion::UnitId>(displayUnitType));
+    return v.convertTo(static_cast<KUnitConversion::UnitId>(displayUnitType)).number();
+}
 
-    const QString unit = degreesOnly ? i18nc("Degree, unit symbol", "°") : v.unit().symbol();
+QString Util::temperatureToDisplayString(int displayUnitType, double value, int valueUnitType, bool rounded, bool degreesOnly) const
+{
+    const Conversion &c = conversion(displayUnitType, valueUnitType);
+    const double number = convert(c, value, displayUnitType, valueUnitType);
+
+    static const QString degrees = i18nc("Degree, unit symbol", "°");
+    const QString &unit = degreesOnly ? degrees : c.symbol;
 
     if (rounded) {
-        int tempNumber = qRound(v.number());
-        return i18nc("temperature unitsymbol", "%1 %2", tempNumber, unit);
+        int tempNumber = qRound(number);
+        return temperaturePattern().arg(m_locale.toString(tempNumber), unit);
     }
 
-    const QString formattedTemp = QLocale().toString(clampValue(v.number(), 1), 'f', 1);
-    return i18nc("temperature unitsymbol", "%1 %2", formattedTemp, unit);
+    const QString formattedTemp = m_locale.toString(clampValue(number, 1), 'f', 1);
+    return temperaturePattern().arg(formattedTemp, unit);
 }
 
 QString Util::valueToDisplayString(int displayUnitType, double value, int valueUnitType, int precision) const
 {
-    KUnitConversion::Value v(value, static_cast<KUnitConversion::UnitId>(valueUnitType));
-    v = v.convertTo(static_cast<KUnitConversion::UnitId>(displayUnitType));
+    const Conversion &c = conversion(displayUnitType, valueUnitType);
+    const double number = convert(c, value, displayUnitType, valueUnitType);
 
     // TODO: fix KUnitConversion to do locale encoded values and use that
-    const QString formattedValue = QLocale().toString(clampValue(v.number(), precision), 'f', precision);
-    return i18nc("value unitsymbol", "%1 %2", formattedValue, v.unit().symbol());
+    const QString formattedValue = m_locale.toString(clampValue(number, precision), 'f', precision);
+    return valuePattern().arg(formattedValue, c.symbol);
 }
 
 QString Util::percentToDisplayString(double value) const
 {
-    const QString formattedPercentValue = QLocale().toString(clampValue(value, 0), 'f', 0);
-    return i18nc("value percentsymbol", "%1 %", formattedPercentValue);
+    static const QString pattern = i18nc("value percentsymbol", "%1 %", QStringLiteral("%1"));
+    return pattern.arg(m_locale.toString(clampValue(value, 0), 'f', 0));
+}
+
+QStringList Util::temperaturesToDisplayStrings(int displayUnitType, const QVariantList &values, int valueUnitType, bool rounded, bool degreesOnly) const
+{
+    QStringList strings;
+    strings.reserve(values.count());
+    for (const QVariant &value : values) {
+        bool ok = false;
+        const double number = value.toDouble(&ok);
+        strings.append(ok ? temperatureToDisplayString(displayUnitType, number, valueUnitType, rounded, degreesOnly) : QString());
+    }
+    return strings;
+}
+
+QStringList Util::valuesToDisplayStrings(int displayUnitType, const QVariantList &values, int valueUnitType, int precision) const
+{
+    QStringList strings;
+    strings.reserve(values.count());
+    for (const QVariant &value : values) {
+        bool ok = false;
+        const double number = value.toDouble(&ok);
+        strings.append(ok ? valueToDisplayString(displayUnitType, number, valueUnitType, precision) : QString());
+    }
+    return strings;
 }
 
 QString Util::nameFromUnitId(KUnitConversion::UnitId unitId)
@@ -10,7 +10,11 @@
 // KF
 #include <KUnitConversion/Converter>
 // Qt
+#include <QHash>
+#include <QLocale>
 #include <QObject>
+#include <QPair>
+#include <QVariantList>
 
 class Util : public QObject
 {
@@ -30,10 +34,39 @@ public:
     Q_INVOKABLE QString valueToDisplayString(int displayUnitType, double value, int valueUnitType, int precision = 0) const;
     Q_INVOKABLE QString percentToDisplayString(double value) const;
 
+    /**
+     * Formats all @p values like temperatureToDisplayString() at once,
+     * the strings of values which are not numbers are empty.
+     */
+    Q_INVOKABLE QStringList temperaturesToDisplayStrings(int displayUnitType,
+                                                         const QVariantList &values,
+                                                         int valueUnitType,
+                                                         bool rounded = false,
+                                                         bool degreesOnly = false) const;
+    /**
+     * Formats all @p values like valueToDisplayString() at once,
+     * the strings of values which are not numbers are empty.
+     */
+    Q_INVOKABLE QStringList valuesToDisplayStrings(int displayUnitType, const QVariantList &values, int valueUnitType, int precision = 0) const;
+
     static QString nameFromUnitId(KUnitConversion::UnitId unitId);
 
 private:
+    // value * factor + offset, if the conversion is linear
+    struct Conversion {
+        bool linear;
+        double factor;
+        double offset;
+        QString symbol;
+    };
+
+    const Conversion &conversion(int displayUnitType, int valueUnitType) const;
+    double convert(const Conversion &conversion, double value, int displayUnitType, int valueUnitType) const;
+
     static KUnitConversion::Converter m_converter;
+
+    QLocale m_locale;
+    mutable QHash<QPair<int, int>, Conversion> m_conversions;
 };
 
 #endif
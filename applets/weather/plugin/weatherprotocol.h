@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef WEATHERPROTOCOL_H
+#define WEATHERPROTOCOL_H
+
+#include <QStringView>
+
+/**
+ * Readers for the '|' separated strings of the weather dataengine.
+ *
+ * They work on views into the data and do not allocate, the fields are only
+ * copied if they are kept.
+ */
+namespace WeatherProtocol
+{
+/**
+ * Yields the fields of a '|' separated string one after the other.
+ */
+class Tokenizer
+{
+public:
+    explicit Tokenizer(QStringView data)
+        : m_data(data)
+    {
+    }
+
+    bool atEnd() const
+    {
+        return m_position > m_data.size();
+    }
+
+    /**
+     * Returns the next field, or an empty view at the end.
+     */
+    QStringView next()
+    {
+        if (atEnd()) {
+            return QStringView();
+        }
+        int end = m_data.indexOf(QLatin1Char('|'), m_position);
+        if (end < 0) {
+            end = m_data.size();
+        }
+        const QStringView field = m_data.mid(m_position, end - m_position);
+        m_position = end + 1;
+        return field;
+    }
+
+    /**
+     * Returns the next field without consuming it.
+     */
+    QStringView peek() const
+    {
+        return Tokenizer(*this).next();
+    }
+
+private:
+    QStringView m_data;
+    int m_position = 0;
+};
+
+/**
+ * An entry of the "ions" source: "display name|id"
+ */
+struct Ion {
+    QStringView displayName;
+    QStringView id;
+
+    static bool parse(QStringView data, Ion *ion)
+    {
+        Tokenizer tokenizer(data);
+        ion->displayName = tokenizer.next();
+        if (tokenizer.atEnd()) {
+            return false;
+        }
+        ion->id = tokenizer.next();
+        return true;
+    }
+};
+
+/**
+ * A weather source: "ion|weather|station[|extra id]"
+ */
+struct Station {
+    QStringView ion;
+    QStringView name;
+    QStringView extra;
+
+    static bool parse(QStringView data, Station *station)
+    {
+        Tokenizer tokenizer(data);
+        station->ion = tokenizer.next();
+        tokenizer.next();
+        if (tokenizer.atEnd() || station->ion.isEmpty()) {
+            return false;
+        }
+        station->name = tokenizer.next();
+        station->extra = tokenizer.next();
+        return !station->name.isEmpty();
+    }
+};
+
+/**
+ * A found place of a validation result.
+ */
+struct Place {
+    QStringView name;
+    // an id the ion needs to tell apart places of the same name, might be empty
+    QStringView extra;
+};
+
+/**
+ * Reads the result of a validation:
+ * "ion|valid|single|place|name[|extra|id]|place|..." if places were found (or "multiple"),
+ * "ion|invalid|single|search term" or "ion|timeout" otherwise.
+ */
+class ValidationReader
+{
+public:
+    explicit ValidationReader(QStringView data)
+        : m_tokenizer(data)
+    {
+        m_ion = m_tokenizer.next();
+        m_hasStatus = !m_tokenizer.atEnd();
+        m_status = m_tokenizer.next();
+        // "single" or "multiple"
+        m_tokenizer.next();
+        if (!isValid()) {
+            m_searchTerm = m_tokenizer.next();
+        }
+    }
+
+    QStringView ion() const
+    {
+        return m_ion;
+    }
+
+    /**
+     * Returns false if the data is not a validation result at all.
+     */
+    bool hasStatus() const
+    {
+        return m_hasStatus;
+    }
+
+    bool isValid() const
+    {
+        return m_status == QLatin1String("valid");
+    }
+
+    bool isTimeout() const
+    {
+        return m_status == QLatin1String("timeout");
+    }
+
+    /**
+     * Returns the search term, only set if the result is not valid.
+     */
+    QStringView searchTerm() const
+    {
+        return m_searchTerm;
+    }
+
+    /**
+     * Reads the next place of a valid result.
+     *
+     * @return false if there are no further places
+     */
+    bool nextPlace(Place *place)
+    {
+        if (!isValid()) {
+            return false;
+        }
+        while (!m_tokenizer.atEnd()) {
+            if (m_tokenizer.next() != QLatin1String("place")) {
+                continue;
+            }
+            if (m_tokenizer.atEnd()) {
+                return false;
+            }
+            place->name = m_tokenizer.next();
+            place->extra = QStringView();
+            if (m_tokenizer.peek() == QLatin1String("extra")) {
+                m_tokenizer.next();
+                place->extra = m_tokenizer.next();
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    Tokenizer m_tokenizer;
+    QStringView m_ion;
+    QStringView m_status;
+    QStringView m_searchTerm;
+    bool m_hasStatus = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "weathersource.h"
+
+#include <QCoreApplication>
+
+// subscribers which are not shown poll this many times less often
+static const int HIDDEN_BACKOFF = 4;
+// ms the data of a source nobody shows anymore is kept
+static const qint64 CACHE_LIFETIME = 30 * 60 * 1000;
+
+WeatherSubscriptions::WeatherSubscriptions(QObject *parent)
+    : QObject(parent)
+{
+    m_expireTimer.setSingleShot(true);
+    connect(&m_expireTimer, &QTimer::timeout, this, &WeatherSubscriptions::expireUnused);
+}
+
+WeatherSubscriptions *WeatherSubscriptions::self()
+{
+    // owned by the application, so the dataengine is released before the plugins are unloaded
+    static WeatherSubscriptions *s_self = new WeatherSubscriptions(QCoreApplication::instance());
+    return s_self;
+}
+
+void WeatherSubscriptions::subscribe(WeatherSource *subscriber)
+{
+    Subscription &subscription = m_subscriptions[subscriber->source()];
+    subscription.subscribers.append(subscriber);
+
+    if (!subscription.data.isEmpty()) {
+        subscriber->setData(subscription.data);
+    }
+
+    updateInterval(subscriber->source());
+}
+
+void WeatherSubscriptions::unsubscribe(WeatherSource *subscriber, const QString &source)
+{
+    auto it = m_subscriptions.find(source);
+    if (it == m_subscriptions.end()) {
+        return;
+    }
+
+    it->subscribers.removeOne(subscriber);
+    if (it->subscribers.isEmpty()) {
+        it->unused.start();
+    }
+    updateInterval(source);
+
+    expireUnused();
+}
+
+void WeatherSubscriptions::updateInterval(const QString &source)
+{
+    auto it = m_subscriptions.find(source);
+    if (it == m_subscriptions.end()) {
+        return;
+    }
+
+    Plasma::DataEngine *engine = dataEngine(QStringLiteral("weather"));
+
+    if (it->subscribers.isEmpty()) {
+        if (it->interval >= 0) {
+            engine->disconnectSource(source, this);
+            it->interval = -1;
+        }
+        return;
+    }
+
+    int interval = -1;
+    for (const WeatherSource *subscriber : qAsConst(it->subscribers)) {
+        const int subscriberInterval = subscriber->isActive() ? subscriber->interval() : subscriber->interval() * HIDDEN_BACKOFF;
+        if (interval < 0 || subscriberInterval < interval) {
+            interval = subscriberInterval;
+        }
+    }
+
+    if (interval != it->interval) {
+        // connecting again only changes the polling interval
+        it->interval = interval;
+        engine->connectSource(source, this, interval);
+    }
+}
+
+void WeatherSubscriptions::expireUnused()
+{
+    qint64 nextExpiry = -1;
+    for (auto it = m_subscriptions.begin(); it != m_subscriptions.end();) {
+        if (!it->subscribers.isEmpty()) {
+            ++it;
+        } else if (it->unused.hasExpired(CACHE_LIFETIME)) {
+            it = m_subscriptions.erase(it);
+        } else {
+            const qint64 remaining = CACHE_LIFETIME - it->unused.elapsed();
+            if (nextExpiry < 0 || remaining < nextExpiry) {
+                nextExpiry = remaining;
+            }
+            ++it;
+        }
+    }
+
+    if (nextExpiry >= 0) {
+        m_expireTimer.start(int(nextExpiry) + 1);
+    } else {
+        m_expireTimer.stop();
+    }
+}
+
+void WeatherSubscriptions::dataUpdated(const QString &source, const Plasma::DataEngine::Data &data)
+{
+    auto it = m_subscriptions.find(source);
+    if (it == m_subscriptions.end()) {
+        return;
+    }
+
+    it->data = data;
+
+    // QML handlers of currentDataChanged may change the source or destroy their item,
+    // which subscribes and unsubscribes right away; iterate a copy and look the
+    // subscription up again before each call instead of keeping the iterator
+    const QVector<WeatherSource *> subscribers = it->subscribers;
+    for (WeatherSource *subscriber : subscribers) {
+        const auto current = m_subscriptions.constFind(source);
+        if (current == m_subscriptions.constEnd()) {
+            return;
+        }
+        // destroyed subscribers have unsubscribed, so they are not in the list anymore
+        if (current->subscribers.contains(subscriber)) {
+            subscriber->setData(data);
+        }
+    }
+}
+
+WeatherSource::WeatherSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+WeatherSource::~WeatherSource()
+{
+    if (m_complete && !m_source.isEmpty()) {
+        WeatherSubscriptions::self()->unsubscribe(this, m_source);
+    }
+}
+
+void WeatherSource::classBegin()
+{
+}
+
+void WeatherSource::componentComplete()
+{
+    m_complete = true;
+    if (!m_source.isEmpty()) {
+        WeatherSubscriptions::self()->subscribe(this);
+    }
+}
+
+QString WeatherSource::source() const
+{
+    return m_source;
+}
+
+void WeatherSource::setSource(const QString &source)
+{
+    if (source == m_source) {
+        return;
+    }
+
+    const QString oldSource = m_source;
+    m_source = source;
+
+    if (!m_data.isEmpty()) {
+        m_data.clear();
+        Q_EMIT currentDataChanged();
+    }
+
+    if (m_complete) {
+        if (!oldSource.isEmpty()) {
+            WeatherSubscriptions::self()->unsubscribe(this, oldSource);
+        }
+        if (!m_source.isEmpty()) {
+            WeatherSubscriptions::self()->subscribe(this);
+        }
+    }
+
+    Q_EMIT sourceChanged();
+}
+
+int WeatherSource::interval() const
+{
+    return m_interval;
+}
+
+void WeatherSource::setInterval(int interval)
+{
+    if (interval == m_interval) {
+        return;
+    }
+
+    m_interval = interval;
+    if (m_complete && !m_source.isEmpty()) {
+        WeatherSubscriptions::self()->updateInterval(m_source);
+    }
+    Q_EMIT intervalChanged();
+}
+
+bool WeatherSource::isActive() const
+{
+    return m_active;
+}
+
+void WeatherSource::setActive(bool active)
+{
+    if (active == m_active) {
+        return;
+    }
+
+    m_active = active;
+    if (m_complete && !m_source.isEmpty()) {
+        WeatherSubscriptions::self()->updateInterval(m_source);
+    }
+    Q_EMIT activeChanged();
+}
+
+QVariant WeatherSource::currentData() const
+{
+    return m_data.isEmpty() ? QVariant() : QVariant(m_data);
+}
+
+void WeatherSource::setData(const Plasma::DataEngine::Data &data)
+{
+    m_data = data;
+    Q_EMIT currentDataChanged();
+}
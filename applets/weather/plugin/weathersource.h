@@ -0,0 +1,115 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef WEATHERSOURCE_H
+#define WEATHERSOURCE_H
+
+#include <Plasma/DataEngine>
+#include <Plasma/DataEngineConsumer>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQmlParserStatus>
+#include <QTimer>
+#include <QVector>
+
+class WeatherSource;
+
+/**
+ * Connects each weather source only once for all applets showing it.
+ *
+ * The source is polled with the shortest interval any subscriber asks for,
+ * subscribers which are not visible ask for a longer one. The last data of
+ * each source is kept for a while, so new subscribers get it right away.
+ */
+class WeatherSubscriptions : public QObject, public Plasma::DataEngineConsumer
+{
+    Q_OBJECT
+
+public:
+    static WeatherSubscriptions *self();
+
+    void subscribe(WeatherSource *subscriber);
+    void unsubscribe(WeatherSource *subscriber, const QString &source);
+
+    /**
+     * Adapts the polling to a changed interval or visibility of a subscriber to @p source.
+     */
+    void updateInterval(const QString &source);
+
+public Q_SLOTS: // callback for the weather dataengine
+    void dataUpdated(const QString &source, const Plasma::DataEngine::Data &data);
+
+private:
+    explicit WeatherSubscriptions(QObject *parent);
+
+    struct Subscription {
+        QVector<WeatherSource *> subscribers;
+        Plasma::DataEngine::Data data;
+        // the interval the source is connected with, -1 if it is not connected
+        int interval = -1;
+        // time since the last subscriber left
+        QElapsedTimer unused;
+    };
+
+    void expireUnused();
+
+    QHash<QString, Subscription> m_subscriptions;
+    // fires when the data of the next unused source is due to be dropped
+    QTimer m_expireTimer;
+};
+
+/**
+ * The data of a weather source for QML, shared with all other users of the source.
+ */
+class WeatherSource : public QObject, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
+    // in ms
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    // whether the data is shown currently, polling slows down otherwise
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    // undefined until data has arrived
+    Q_PROPERTY(QVariant currentData READ currentData NOTIFY currentDataChanged)
+
+public:
+    explicit WeatherSource(QObject *parent = nullptr);
+    ~WeatherSource() override;
+
+    QString source() const;
+    void setSource(const QString &source);
+
+    int interval() const;
+    void setInterval(int interval);
+
+    bool isActive() const;
+    void setActive(bool active);
+
+    QVariant currentData() const;
+    void setData(const Plasma::DataEngine::Data &data);
+
+    void classBegin() override;
+    void componentComplete() override;
+
+Q_SIGNALS:
+    void sourceChanged();
+    void intervalChanged();
+    void activeChanged();
+    void currentDataChanged();
+
+private:
+    QString m_source;
+    int m_interval = 0;
+    bool m_active = true;
+    bool m_complete = false;
+    Plasma::DataEngine::Data m_data;
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#include "comicproviderwrapper.h"
+
+#include <QTest>
+
+class ComicImageTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testCombine();
+    void testCombineBackground();
+    void benchmarkCombinePanels();
+};
+
+static QImage filledImage(const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    return image;
+}
+
+void ComicImageTest::testCombine()
+{
+    const QImage header = filledImage(QSize(100, 20), Qt::red);
+    const QImage comic = filledImage(QSize(100, 50), Qt::blue);
+
+    QImage combined = ComicProviderWrapper::combineImages(header, comic, ComicProviderWrapper::Top);
+    QCOMPARE(combined.size(), QSize(100, 70));
+    QCOMPARE(combined.pixelColor(50, 10), QColor(Qt::red));
+    QCOMPARE(combined.pixelColor(50, 40), QColor(Qt::blue));
+
+    combined = ComicProviderWrapper::combineImages(header, comic, ComicProviderWrapper::Bottom);
+    QCOMPARE(combined.size(), QSize(100, 70));
+    QCOMPARE(combined.pixelColor(50, 10), QColor(Qt::blue));
+    QCOMPARE(combined.pixelColor(50, 60), QColor(Qt::red));
+
+    combined = ComicProviderWrapper::combineImages(header, comic, ComicProviderWrapper::Left);
+    QCOMPARE(combined.size(), QSize(200, 50));
+    QCOMPARE(combined.pixelColor(50, 25), QColor(Qt::red));
+    QCOMPARE(combined.pixelColor(150, 25), QColor(Qt::blue));
+
+    combined = ComicProviderWrapper::combineImages(header, comic, ComicProviderWrapper::Right);
+    QCOMPARE(combined.size(), QSize(200, 50));
+    QCOMPARE(combined.pixelColor(50, 25), QColor(Qt::blue));
+    QCOMPARE(combined.pixelColor(150, 25), QColor(Qt::red));
+}
+
+void ComicImageTest::testCombineBackground()
+{
+    // the narrower image is centered, the gaps get the color of the header's corner
+    QImage header = filledImage(QSize(100, 20), Qt::red);
+    header.setPixelColor(0, 0, Qt::green);
+    const QImage comic = filledImage(QSize(50, 50), Qt::blue);
+
+    const QImage combined = ComicProviderWrapper::combineImages(header, comic, ComicProviderWrapper::Top);
+    QCOMPARE(combined.size(), QSize(100, 70));
+    QCOMPARE(combined.pixelColor(10, 40), QColor(Qt::green));
+    QCOMPARE(combined.pixelColor(50, 40), QColor(Qt::blue));
+    QCOMPARE(combined.pixelColor(90, 40), QColor(Qt::green));
+}
+
+void ComicImageTest::benchmarkCombinePanels()
+{
+    // a strip put together from eight panels, as multi panel comic scripts do
+    const QImage panel = filledImage(QSize(800, 600), Qt::white);
+
+    QBENCHMARK {
+        QImage strip = panel;
+        for (int i = 1; i < 8; ++i) {
+            strip = ComicProviderWrapper::combineImages(panel, strip, ComicProviderWrapper::Bottom);
+        }
+        QCOMPARE(strip.height(), 8 * 600);
+    }
+}
+
+QTEST_MAIN(ComicImageTest)
+
+#include "comicimagetest.moc"
@@ -0,0 +1,128 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#include "scriptenginepool.h"
+
+#include <QFile>
+#include <QJSEngine>
+#include <QTemporaryDir>
+#include <QTest>
+
+// a provider script with the helpers a typical comic defines, init() leaves a global behind
+static const char s_script[] = R"(
+var months = ["January", "February", "March", "April", "May", "June",
+              "July", "August", "September", "October", "November", "December"];
+
+function pad(number) {
+    return number < 10 ? "0" + number : "" + number;
+}
+
+function stripUrl(year, month, day) {
+    return "https://comic.example/" + year + "/" + pad(month) + "/" + pad(day) + "/";
+}
+
+function parseTitle(html) {
+    var match = /<h1 class="title">([^<]*)<\/h1>/.exec(html);
+    return match ? match[1] : "";
+}
+
+function init() {
+    var urls = [];
+    for (var day = 1; day <= 28; ++day) {
+        urls.push(stripUrl(2021, 2, day));
+    }
+    comic.websiteUrl = urls[urls.length - 1];
+    comic.title = parseTitle("<h1 class=\"title\">" + months[1] + "</h1>");
+    lastRequest = comic.websiteUrl;
+}
+)";
+
+class ScriptEnginePoolTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testReuse();
+    void benchmarkRequest_data();
+    void benchmarkRequest();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_scriptPath;
+};
+
+void ScriptEnginePoolTest::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_scriptPath = m_dir.filePath(QStringLiteral("main.es"));
+    QFile file(m_scriptPath);
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(s_script);
+}
+
+static void setComic(QJSEngine *engine)
+{
+    // stands in for the provider's "comic" object
+    engine->globalObject().setProperty(QStringLiteral("comic"), engine->newObject());
+}
+
+void ScriptEnginePoolTest::testReuse()
+{
+    PooledScriptEngine *script = ScriptEnginePool::self()->acquire(m_scriptPath);
+    QVERIFY(!script->isEvaluated());
+    setComic(script->engine());
+    QVERIFY(script->evaluate());
+    QVERIFY(script->functions().contains(QStringLiteral("init")));
+    script->call(QStringLiteral("init"));
+    QVERIFY(script->engine()->globalObject().hasProperty(QStringLiteral("lastRequest")));
+    ScriptEnginePool::self()->release(script);
+
+    PooledScriptEngine *reused = ScriptEnginePool::self()->acquire(m_scriptPath);
+    QCOMPARE(reused, script);
+    QVERIFY(reused->isEvaluated());
+    QVERIFY(!reused->engine()->globalObject().hasProperty(QStringLiteral("lastRequest")));
+    QVERIFY(reused->engine()->globalObject().property(QStringLiteral("comic")).isUndefined());
+    ScriptEnginePool::self()->release(reused);
+}
+
+void ScriptEnginePoolTest::benchmarkRequest_data()
+{
+    QTest::addColumn<bool>("pooled");
+
+    QTest::newRow("fresh engine") << false;
+    QTest::newRow("pooled engine") << true;
+}
+
+void ScriptEnginePoolTest::benchmarkRequest()
+{
+    QFETCH(bool, pooled);
+
+    // what every strip request runs: set up the engine with the script evaluated and call init()
+    if (pooled) {
+        QBENCHMARK {
+            PooledScriptEngine *script = ScriptEnginePool::self()->acquire(m_scriptPath);
+            setComic(script->engine());
+            if (!script->isEvaluated()) {
+                script->evaluate();
+            }
+            script->call(QStringLiteral("init"));
+            ScriptEnginePool::self()->release(script);
+        }
+    } else {
+        QBENCHMARK {
+            QFile file(m_scriptPath);
+            file.open(QFile::ReadOnly);
+            QJSEngine engine;
+            setComic(&engine);
+            engine.evaluate(QString::fromUtf8(file.readAll()), m_scriptPath);
+            engine.globalObject().property(QStringLiteral("init")).call();
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(ScriptEnginePoolTest)
+
+#include "scriptenginepooltest.moc"
@@ -7,6 +7,7 @@
 #include "cachedprovider.h"
 #include "comic_debug.h"
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -18,11 +19,72 @@
 
 const int CachedProvider::CACHE_DEFAULT = 20;
 
+static QString cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/plasma_engine_comic/");
+}
+
 static QString identifierToPath(const QString &identifier)
 {
-    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/plasma_engine_comic/");
+    return cacheDir() + QString::fromLatin1(QUrl::toPercentEncoding(identifier));
+}
+
+/**
+ * The images are stored content addressed in blobs/, the config file of each
+ * identifier references its image with the "blob" key. blobs.conf lists the
+ * identifiers referencing each image, an image is removed with its last reference.
+ */
+static QString blobPath(const QString &hash)
+{
+    return cacheDir() + QLatin1String("blobs/") + hash + QLatin1String(".png");
+}
+
+static QString blobIndexPath()
+{
+    return cacheDir() + QLatin1String("blobs.conf");
+}
+
+static QString blobOf(const QString &path)
+{
+    QSettings settings(path + QLatin1String(".conf"), QSettings::IniFormat);
+    return settings.value(QLatin1String("blob"), QString()).toString();
+}
+
+static QString imageHash(const QImage &image)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(image.format()) + 'x' + QByteArray::number(image.width()) + 'x' + QByteArray::number(image.height()));
+    // only hash the used bytes of each line, the padding is not initialized
+    const int lineLength = (image.width() * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        hash.addData(reinterpret_cast<const char *>(image.constScanLine(y)), lineLength);
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+static void releaseBlob(const QString &hash, const QString &fileName)
+{
+    QSettings blobs(blobIndexPath(), QSettings::IniFormat);
+    QStringList refs = blobs.value(hash, QStringList()).toStringList();
+    refs.removeAll(fileName);
+    if (refs.isEmpty()) {
+        qCDebug(PLASMA_COMIC) << "Remove unreferenced image" << hash;
+        blobs.remove(hash);
+        QFile::remove(blobPath(hash));
+    } else {
+        blobs.setValue(hash, refs);
+    }
+}
 
-    return dataDir + QString::fromLatin1(QUrl::toPercentEncoding(identifier));
+static void removeFromCache(const QString &fileName)
+{
+    const QString path = cacheDir() + fileName;
+    const QString hash = blobOf(path);
+    if (!hash.isEmpty()) {
+        releaseBlob(hash, fileName);
+    }
+    QFile::remove(path);
+    QFile::remove(path + QLatin1String(".conf"));
 }
 
 CachedProvider::CachedProvider(QObject *parent, const QVariantList &args)
@@ -42,12 +104,15 @@ ComicProvider::IdentifierType CachedProvider::identifierType() const
 
 QImage CachedProvider::image() const
 {
-    if (!QFile::exists(identifierToPath(requestedString()))) {
+    const QString hash = blobOf(identifierToPath(requestedString()));
+    // strips cached before images were shared are still stored per identifier
+    const QString path = hash.isEmpty() ? identifierToPath(requestedString()) : blobPath(hash);
+    if (!QFile::exists(path)) {
         return QImage();
     }
 
     QImage img;
-    img.load(identifierToPath(requestedString()), "PNG");
+    img.load(path, "PNG");
 
     return img;
 }
@@ -118,7 +183,12 @@ void CachedProvider::triggerFinished()
 
 bool CachedProvider::isCached(const QString &identifier)
 {
-    return QFile::exists(identifierToPath(identifier));
+    const QString path = identifierToPath(identifier);
+    if (QFile::exists(path)) {
+        return true;
+    }
+    const QString hash = blobOf(path);
+    return !hash.isEmpty() && QFile::exists(blobPath(hash));
 }
 
 bool CachedProvider::storeInCache(const QString &identifier, const QImage &comic, const Settings &info)
@@ -128,7 +198,35 @@ bool CachedProvider::storeInCache(const QString &identifier, const QImage &comic
     int index = identifier.indexOf(QLatin1Char(':'));
     const QString comicName = identifier.mid(0, index);
     const QString pathMain = identifierToPath(comicName);
-    const QString dirPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/plasma_engine_comic/");
+    const QString dirPath = cacheDir();
+    const QString fileName = QString::fromLatin1(QUrl::toPercentEncoding(identifier));
+
+    const QString hash = imageHash(comic);
+    if (!QFile::exists(blobPath(hash))) {
+        QDir().mkpath(dirPath + QLatin1String("blobs"));
+        if (!comic.save(blobPath(hash), "PNG")) {
+            return false;
+        }
+    } else {
+        qCDebug(PLASMA_COMIC) << identifier << "shares its image with an already cached strip.";
+    }
+
+    const QString oldHash = blobOf(path);
+    if (oldHash != hash) {
+        if (!oldHash.isEmpty()) {
+            releaseBlob(oldHash, fileName);
+        }
+        {
+            QSettings settings(path + QLatin1String(".conf"), QSettings::IniFormat);
+            settings.setValue(QLatin1String("blob"), hash);
+        }
+        QSettings blobs(blobIndexPath(), QSettings::IniFormat);
+        QStringList refs = blobs.value(hash, QStringList()).toStringList();
+        refs.append(fileName);
+        blobs.setValue(hash, refs);
+    }
+    // the image of an old style cache entry is shared now
+    QFile::remove(path);
 
     if (!info.isEmpty()) {
         QSettings settings(path + QLatin1String(".conf"), QSettings::IniFormat);
@@ -163,7 +261,8 @@ bool CachedProvider::storeInCache(const QString &identifier, const QImage &comic
                 }
             }
         }
-        comics.append(QString::fromLatin1(QUrl::toPercentEncoding(identifier)));
+        comics.removeAll(fileName);
+        comics.append(fileName);
 
         const int limit = CachedProvider::maxComicLimit();
         // limit is on
@@ -173,8 +272,7 @@ bool CachedProvider::storeInCache(const QString &identifier, const QImage &comic
             QStringList::iterator it = comics.begin();
             while (comicsToRemove > 0 && it != comics.end()) {
                 qCDebug(PLASMA_COMIC) << QLatin1String("Remove file") << (dirPath + (*it));
-                QFile::remove(dirPath + (*it));
-                QFile::remove(dirPath + (*it) + QLatin1String(".conf"));
+                removeFromCache(*it);
                 it = comics.erase(it);
                 --comicsToRemove;
             }
@@ -182,7 +280,7 @@ bool CachedProvider::storeInCache(const QString &identifier, const QImage &comic
         settingsMain.setValue(QLatin1String("comics"), comics);
     }
 
-    return comic.save(path, "PNG");
+    return true;
 }
 
 QUrl CachedProvider::websiteUrl() const
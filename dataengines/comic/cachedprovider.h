@@ -120,6 +120,8 @@ public:
 
     /**
      * Stores the given @p comic with the given @p identifier in the cache.
+     *
+     * Images are stored once per content, identifiers showing the same image share it.
      */
     static bool storeInCache(const QString &identifier, const QImage &comic, const Settings &info = Settings());
 
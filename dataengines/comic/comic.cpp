@@ -19,6 +19,7 @@
 
 #include "cachedprovider.h"
 #include "comic_debug.h"
+#include "comicsources.h"
 #include "comicproviderkross.h"
 
 ComicEngine::ComicEngine(QObject *parent, const QVariantList &args)
@@ -85,10 +86,12 @@ bool ComicEngine::updateSourceEvent(const QString &identifier)
             return true;
         }
 
-        const QStringList parts = identifier.split(QLatin1Char(':'), Qt::KeepEmptyParts);
+        const bool isProbe = identifier.startsWith(ComicSources::PROBE_PREFIX);
+        const QString request = isProbe ? identifier.mid(ComicSources::PROBE_PREFIX.size()) + QLatin1Char(':') : identifier;
+        const QStringList parts = request.split(QLatin1Char(':'), Qt::KeepEmptyParts);
 
         // check whether it is cached, make sure second part present
-        if (parts.count() > 1 && CachedProvider::isCached(identifier)) {
+        if (!isProbe && parts.count() > 1 && CachedProvider::isCached(identifier)) {
             QVariantList args;
             args << QLatin1String("String") << identifier;
 
@@ -117,6 +120,10 @@ bool ComicEngine::updateSourceEvent(const QString &identifier)
 
         // check if there is a connection
         if (!m_networkConfigurationManager.isOnline()) {
+            if (isProbe) {
+                setData(identifier, QLatin1String("Error"), true);
+                return true;
+            }
             mIdentifierError = identifier;
             setData(identifier, QLatin1String("Error"), true);
             setData(identifier, QLatin1String("Error automatically fixable"), true);
@@ -156,6 +163,7 @@ bool ComicEngine::updateSourceEvent(const QString &identifier)
             return false;
         }
         provider->setIsCurrent(isCurrentComic);
+        provider->setIsProbe(isProbe);
 
         m_jobs[identifier] = provider;
 
@@ -174,6 +182,11 @@ bool ComicEngine::sourceRequestEvent(const QString &identifier)
 
 void ComicEngine::finished(ComicProvider *provider)
 {
+    if (provider->isProbe()) {
+        probeFinished(provider, false);
+        return;
+    }
+
     // sets the data
     setComicData(provider);
     if (provider->image().isNull()) {
@@ -237,6 +250,11 @@ void ComicEngine::finished(ComicProvider *provider)
 
 void ComicEngine::error(ComicProvider *provider)
 {
+    if (provider->isProbe()) {
+        probeFinished(provider, true);
+        return;
+    }
+
     // sets the data
     setComicData(provider);
 
@@ -273,6 +291,18 @@ void ComicEngine::error(ComicProvider *provider)
     provider->deleteLater();
 }
 
+void ComicEngine::probeFinished(ComicProvider *provider, bool error)
+{
+    const QString key = m_jobs.key(provider);
+    if (!key.isEmpty()) {
+        m_jobs.remove(key);
+        setData(key, QLatin1String("Identifier"), error ? QString() : provider->identifier());
+        setData(key, QLatin1String("Error"), error);
+    }
+
+    provider->deleteLater();
+}
+
 void ComicEngine::setComicData(ComicProvider *provider)
 {
     QString identifier(provider->identifier());
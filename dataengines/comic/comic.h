@@ -25,6 +25,9 @@ class ComicProvider;
  *   xkcd:378
  * if the suffix is empty the latest comic will be returned
  *
+ * To only find out the identifier of the latest strip, without downloading it, query
+ *   latest_strip:\<comic_identifier\>
+ *
  */
 class ComicEngine : public Plasma::DataEngine
 {
@@ -52,6 +55,7 @@ private Q_SLOTS:
 private:
     bool mEmptySuffix;
     void setComicData(ComicProvider *provider);
+    void probeFinished(ComicProvider *provider, bool error);
     QString lastCachedIdentifier(const QString &identifier) const;
     QString mIdentifierError;
     QStringList mProviders;
@@ -19,6 +19,7 @@ public:
     Private(const KPluginMetaData &data, ComicProvider *parent)
         : mParent(parent)
         , mIsCurrent(false)
+        , mIsProbe(false)
         , mFirstStripNumber(1)
         , mComicDescription(data)
     {
@@ -68,6 +69,7 @@ public:
     QString mComicAuthor;
     QUrl mImageUrl;
     bool mIsCurrent;
+    bool mIsProbe;
     bool mIsLeftToRight;
     bool mIsTopToBottom;
     QDate mRequestedDate;
@@ -149,6 +151,16 @@ bool ComicProvider::isCurrent() const
     return d->mIsCurrent;
 }
 
+void ComicProvider::setIsProbe(bool value)
+{
+    d->mIsProbe = value;
+}
+
+bool ComicProvider::isProbe() const
+{
+    return d->mIsProbe;
+}
+
 QDate ComicProvider::requestedDate() const
 {
     return d->mRequestedDate;
@@ -224,6 +236,10 @@ void ComicProvider::requestPage(const QUrl &url, int id, const MetaInfos &infos)
     if (id == Image) {
         // use cached information for the image if available
         job = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
+    } else if (d->mIsProbe) {
+        // probes run often, only download the webpage if it changed
+        job = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
+        job->addMetaData(QStringLiteral("cache"), QStringLiteral("verify"));
     } else {
         // for webpages we always reload, making sure, that changes are recognised
         job = KIO::storedGet(url, KIO::Reload, KIO::HideProgressInfo);
@@ -161,6 +161,18 @@ public:
      */
     bool isCurrent() const;
 
+    /**
+     * Set whether only the identifier of the latest strip is requested (only used internally).
+     * Such a probe finishes once the strip image is requested, without downloading it,
+     * and revalidates the pages it fetches instead of always reloading them.
+     */
+    void setIsProbe(bool value);
+
+    /**
+     * Returns whether only the identifier of the latest strip is requested (only used internally).
+     */
+    bool isProbe() const;
+
 Q_SIGNALS:
     /**
      * This signal is emitted whenever a request has been finished
@@ -6,48 +6,119 @@
 
 #include "comicproviderkross.h"
 #include "comic_package.h"
+#include "scriptenginepool.h"
 #include <KPackage/PackageLoader>
+#include <QTimer>
 
 KPackage::PackageStructure *ComicProviderKross::m_packageStructure(nullptr);
 
 ComicProviderKross::ComicProviderKross(QObject *parent, const QVariantList &args)
     : ComicProvider(parent, args)
-    , m_wrapper(this)
 {
+    // isCurrent() and isProbe() are only set after construction
+    QTimer::singleShot(0, this, &ComicProviderKross::startScript);
 }
 
 ComicProviderKross::~ComicProviderKross()
 {
+    if (m_wrapper) {
+        // deleted on the worker thread once the script call in progress, if any, is done
+        m_wrapper->deleteLater();
+    }
+}
+
+void ComicProviderKross::startScript()
+{
+    m_wrapper = new ComicProviderWrapper(this);
+    // the requested strip, until the script reports back
+    m_result.identifier = m_wrapper->identifierVariant();
+    m_wrapper->moveToThread(ScriptEnginePool::self()->workerThread());
+
+    connect(this, &ComicProviderKross::scriptPageRetrieved, m_wrapper, &ComicProviderWrapper::pageRetrieved);
+    connect(this, &ComicProviderKross::scriptPageError, m_wrapper, &ComicProviderWrapper::pageError);
+    connect(this, &ComicProviderKross::scriptRedirected, m_wrapper, &ComicProviderWrapper::redirected);
+
+    const auto toMetaInfos = [](const QVariantMap &infos) {
+        MetaInfos map;
+        for (auto it = infos.begin(), end = infos.end(); it != end; ++it) {
+            map[it.key()] = it.value().toString();
+        }
+        return map;
+    };
+    connect(m_wrapper, &ComicProviderWrapper::pageRequested, this, [this, toMetaInfos](const QUrl &url, int id, const QVariantMap &infos) {
+        requestPage(url, id, toMetaInfos(infos));
+    });
+    connect(m_wrapper, &ComicProviderWrapper::redirectedUrlRequested, this, [this, toMetaInfos](const QUrl &url, int id, const QVariantMap &infos) {
+        requestRedirectedUrl(url, id, toMetaInfos(infos));
+    });
+    connect(m_wrapper, &ComicProviderWrapper::stripFinished, this, [this](const ComicScriptResult &result) {
+        setResult(result);
+        Q_EMIT finished(this);
+    });
+    connect(m_wrapper, &ComicProviderWrapper::stripFailed, this, [this](const ComicScriptResult &result) {
+        setResult(result);
+        Q_EMIT error(this);
+    });
+
+    QMetaObject::invokeMethod(m_wrapper, &ComicProviderWrapper::init, Qt::QueuedConnection);
+}
+
+void ComicProviderKross::setResult(const ComicScriptResult &result)
+{
+    m_result = result;
+    setComicAuthor(result.comicAuthor);
+
+    if (!result.firstIdentifier.isNull()) {
+        switch (identifierType()) {
+        case DateIdentifier:
+            setFirstStripDate(result.firstIdentifier.toDate());
+            break;
+        case NumberIdentifier:
+            setFirstStripNumber(result.firstIdentifier.toInt());
+            break;
+        case StringIdentifier:
+            break;
+        }
+    }
 }
 
 bool ComicProviderKross::isLeftToRight() const
 {
-    return m_wrapper.isLeftToRight();
+    return m_result.isLeftToRight;
 }
 
 bool ComicProviderKross::isTopToBottom() const
 {
-    return m_wrapper.isTopToBottom();
+    return m_result.isTopToBottom;
 }
 
 ComicProvider::IdentifierType ComicProviderKross::identifierType() const
 {
-    return m_wrapper.identifierType();
+    IdentifierType result = StringIdentifier;
+    const QString type = description().value(QLatin1String("X-KDE-PlasmaComicProvider-SuffixType"));
+    if (type == QLatin1String("Date")) {
+        result = DateIdentifier;
+    } else if (type == QLatin1String("Number")) {
+        result = NumberIdentifier;
+    } else if (type == QLatin1String("String")) {
+        result = StringIdentifier;
+    }
+    return result;
 }
 
 QUrl ComicProviderKross::websiteUrl() const
 {
-    return QUrl(m_wrapper.websiteUrl());
+    return QUrl(m_result.websiteUrl);
 }
 
 QUrl ComicProviderKross::shopUrl() const
 {
-    return QUrl(m_wrapper.shopUrl());
+    return QUrl(m_result.shopUrl);
 }
 
 QImage ComicProviderKross::image() const
 {
-    return m_wrapper.comicImage();
+    return m_result.image;
 }
 
 QString ComicProviderKross::identifierToString(const QVariant &identifier) const
@@ -66,47 +137,47 @@ QString ComicProviderKross::identifierToString(const QVariant &identifier) const
 
 QString ComicProviderKross::identifier() const
 {
-    return pluginName() + QLatin1Char(':') + identifierToString(m_wrapper.identifierVariant());
+    return pluginName() + QLatin1Char(':') + identifierToString(m_result.identifier);
 }
 
 QString ComicProviderKross::nextIdentifier() const
 {
-    return identifierToString(m_wrapper.nextIdentifierVariant());
+    return identifierToString(m_result.nextIdentifier);
 }
 
 QString ComicProviderKross::previousIdentifier() const
 {
-    return identifierToString(m_wrapper.previousIdentifierVariant());
+    return identifierToString(m_result.previousIdentifier);
 }
 
 QString ComicProviderKross::firstStripIdentifier() const
 {
-    return identifierToString(m_wrapper.firstIdentifierVariant());
+    return identifierToString(m_result.firstIdentifier);
 }
 
 QString ComicProviderKross::stripTitle() const
 {
-    return m_wrapper.title();
+    return m_result.title;
 }
 
 QString ComicProviderKross::additionalText() const
 {
-    return m_wrapper.additionalText();
+    return m_result.additionalText;
 }
 
 void ComicProviderKross::pageRetrieved(int id, const QByteArray &data)
 {
-    m_wrapper.pageRetrieved(id, data);
+    Q_EMIT scriptPageRetrieved(id, data);
 }
 
 void ComicProviderKross::pageError(int id, const QString &message)
 {
-    m_wrapper.pageError(id, message);
+    Q_EMIT scriptPageError(id, message);
 }
 
 void ComicProviderKross::redirected(int id, const QUrl &newUrl)
 {
-    m_wrapper.redirected(id, newUrl);
+    Q_EMIT scriptRedirected(id, newUrl);
 }
 
 KPackage::PackageStructure *ComicProviderKross::packageStructure()
@@ -44,8 +44,19 @@ protected:
     void redirected(int id, const QUrl &newUrl) override;
     QString identifierToString(const QVariant &identifier) const;
 
+Q_SIGNALS:
+    // forwarded to the script on the worker thread
+    void scriptPageRetrieved(int id, const QByteArray &data);
+    void scriptPageError(int id, const QString &message);
+    void scriptRedirected(int id, const QUrl &newUrl);
+
 private:
-    mutable ComicProviderWrapper m_wrapper;
+    void startScript();
+    void setResult(const ComicScriptResult &result);
+
+    // lives on the worker thread of the script engine pool
+    ComicProviderWrapper *m_wrapper = nullptr;
+    ComicScriptResult m_result;
     static KPackage::PackageStructure *m_packageStructure;
 };
 
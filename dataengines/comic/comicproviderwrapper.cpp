@@ -8,12 +8,12 @@
 #include "comicproviderwrapper.h"
 #include "comic_debug.h"
 #include "comicproviderkross.h"
+#include "scriptenginepool.h"
 
 #include <Plasma/Package>
 #include <QFile>
 #include <QFileInfo>
 #include <QJSEngine>
-#include <QJSValueIterator>
 #include <QJSValueList>
 #include <QPainter>
 #include <QStandardPaths>
@@ -25,20 +25,24 @@ QStringList ComicProviderWrapper::mExtensions;
 
 ImageWrapper::ImageWrapper(QObject *parent, const QByteArray &data)
     : QObject(parent)
-    , mImage(QImage::fromData(data))
     , mRawData(data)
+    , mImageDecoded(false)
 {
-    resetImageReader();
 }
 
 QImage ImageWrapper::image() const
 {
+    if (!mImageDecoded) {
+        mImage = QImage::fromData(mRawData);
+        mImageDecoded = true;
+    }
     return mImage;
 }
 
 void ImageWrapper::setImage(const QImage &image)
 {
     mImage = image;
+    mImageDecoded = true;
     mRawData.clear();
 
     resetImageReader();
@@ -57,29 +61,41 @@ QByteArray ImageWrapper::rawData() const
 void ImageWrapper::setRawData(const QByteArray &rawData)
 {
     mRawData = rawData;
-    mImage = QImage::fromData(mRawData);
+    mImage = QImage();
+    mImageDecoded = false;
 
     resetImageReader();
 }
 
 void ImageWrapper::resetImageReader()
 {
+    // the reader is only set up again once it is used, to not encode
+    // images which are just combined or passed on
     if (mBuffer.isOpen()) {
         mBuffer.close();
     }
-    rawData(); // to update the rawData if needed
-    mBuffer.setBuffer(&mRawData);
-    mBuffer.open(QIODevice::ReadOnly);
-    mImageReader.setDevice(&mBuffer);
+    mImageReader.setDevice(nullptr);
+}
+
+void ImageWrapper::ensureImageReader() const
+{
+    if (!mBuffer.isOpen()) {
+        rawData(); // to update the rawData if needed
+        mBuffer.setBuffer(&mRawData);
+        mBuffer.open(QIODevice::ReadOnly);
+        mImageReader.setDevice(&mBuffer);
+    }
 }
 
 int ImageWrapper::imageCount() const
 {
+    ensureImageReader();
     return mImageReader.imageCount();
 }
 
 QImage ImageWrapper::read()
 {
+    ensureImageReader();
     return mImageReader.read();
 }
 
@@ -257,30 +273,46 @@ QString StaticDateWrapper::shortMonthName(int month)
     return QLocale::system().monthName(month, QLocale::ShortFormat);
 }
 
-ComicProviderWrapper::ComicProviderWrapper(ComicProviderKross *parent)
-    : QObject(parent)
-    , mProvider(parent)
+ComicProviderWrapper::ComicProviderWrapper(const ComicProviderKross *provider)
+    : mPluginName(provider->pluginName())
+    , mIdentifierType(provider->identifierType())
+    , mIsProbe(provider->isProbe())
+    , mComicAuthor(provider->comicAuthor())
     , mKrossImage(nullptr)
     , mPackage(nullptr)
     , mRequests(0)
-    , mIdentifierSpecified(false)
+    , mIdentifierSpecified(!provider->isCurrent())
     , mIsLeftToRight(true)
     , mIsTopToBottom(true)
 {
-    QTimer::singleShot(0, this, &ComicProviderWrapper::init);
+    qRegisterMetaType<ComicScriptResult>();
+
+    switch (mIdentifierType) {
+    case ComicProvider::DateIdentifier:
+        mRequestedIdentifier = provider->requestedDate();
+        break;
+    case ComicProvider::NumberIdentifier:
+        mRequestedIdentifier = provider->requestedNumber();
+        break;
+    case ComicProvider::StringIdentifier:
+        mRequestedIdentifier = provider->requestedString();
+        break;
+    }
+    setIdentifierToDefault();
 }
 
 ComicProviderWrapper::~ComicProviderWrapper()
 {
+    ScriptEnginePool::self()->release(m_script);
     delete mPackage;
 }
 
 void ComicProviderWrapper::init()
 {
     const QString path = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-                                                QLatin1String("plasma/comics/") + mProvider->pluginName() + QLatin1Char('/'),
+                                                QLatin1String("plasma/comics/") + mPluginName + QLatin1Char('/'),
                                                 QStandardPaths::LocateDirectory);
-    qCDebug(PLASMA_COMIC) << "ComicProviderWrapper::init() package is" << mProvider->pluginName() << " at " << path;
+    qCDebug(PLASMA_COMIC) << "ComicProviderWrapper::init() package is" << mPluginName << " at " << path;
 
     if (!path.isEmpty()) {
         mPackage = new KPackage::Package(ComicProviderKross::packageStructure());
@@ -302,38 +334,33 @@ void ComicProviderWrapper::init()
             }
 
             if (info.exists()) {
-                m_engine = new QJSEngine(this);
-                QFile f(info.absoluteFilePath());
-                if (f.open(QFile::ReadOnly)) {
-                    m_engine->globalObject().setProperty("Comic", m_engine->newQMetaObject(&ComicProviderWrapper::staticMetaObject));
-                    auto obj = m_engine->newQObject(this);
-
-                    // If we set the comic in the global object we can not access the staticMetaObject
-                    // consequently the values have to be written manually
-                    obj.setProperty("Page", ComicProvider::Page);
-                    obj.setProperty("Image", ComicProvider::Image);
-                    obj.setProperty("User", ComicProvider::User);
-                    obj.setProperty("Left", ComicProviderWrapper::Left);
-                    obj.setProperty("Top", ComicProviderWrapper::Top);
-                    obj.setProperty("Right", ComicProviderWrapper::Right);
-                    obj.setProperty("Bottom", ComicProviderWrapper::Bottom);
-                    obj.setProperty("DateIdentifier", ComicProvider::DateIdentifier);
-                    obj.setProperty("NumberIdentifier", ComicProvider::NumberIdentifier);
-                    obj.setProperty("StringIdentifier", ComicProvider::StringIdentifier);
-
-                    m_engine->globalObject().setProperty("comic", obj);
-                    m_engine->globalObject().setProperty("date", m_engine->newQObject(new StaticDateWrapper(this)));
-                    m_engine->evaluate("var print = comic.print");
-                    mIdentifierSpecified = !mProvider->isCurrent();
-                    m_engine->evaluate(f.readAll(), info.absoluteFilePath());
-                    QJSValueIterator it(m_engine->globalObject());
-                    while (it.hasNext()) {
-                        it.next();
-                        if (it.value().isCallable()) {
-                            mFunctions << it.name();
-                        }
-                    }
-                    setIdentifierToDefault();
+                m_script = ScriptEnginePool::self()->acquire(info.absoluteFilePath());
+                m_engine = m_script->engine();
+                // set again for a pooled engine as well, the previous provider's script may have modified them;
+                // without a parent the date wrapper is owned and collected by the engine
+                m_engine->globalObject().setProperty("Comic", m_engine->newQMetaObject(&ComicProviderWrapper::staticMetaObject));
+                m_engine->globalObject().setProperty("date", m_engine->newQObject(new StaticDateWrapper()));
+                auto obj = m_engine->newQObject(this);
+
+                // If we set the comic in the global object we can not access the staticMetaObject
+                // consequently the values have to be written manually
+                obj.setProperty("Page", ComicProvider::Page);
+                obj.setProperty("Image", ComicProvider::Image);
+                obj.setProperty("User", ComicProvider::User);
+                obj.setProperty("Left", ComicProviderWrapper::Left);
+                obj.setProperty("Top", ComicProviderWrapper::Top);
+                obj.setProperty("Right", ComicProviderWrapper::Right);
+                obj.setProperty("Bottom", ComicProviderWrapper::Bottom);
+                obj.setProperty("DateIdentifier", ComicProvider::DateIdentifier);
+                obj.setProperty("NumberIdentifier", ComicProvider::NumberIdentifier);
+                obj.setProperty("StringIdentifier", ComicProvider::StringIdentifier);
+
+                m_engine->globalObject().setProperty("comic", obj);
+                m_engine->globalObject().setProperty("print", obj.property("print"));
+
+                // the script only has to be evaluated once per engine, pooled engines already know its functions
+                if (m_script->isEvaluated() || m_script->evaluate()) {
+                    mFunctions = m_script->functions();
                     callFunction(QStringLiteral("init"));
                 }
             }
@@ -343,28 +370,32 @@ void ComicProviderWrapper::init()
 
 ComicProvider::IdentifierType ComicProviderWrapper::identifierType() const
 {
-    ComicProvider::IdentifierType result = ComicProvider::StringIdentifier;
-    const QString type = mProvider->description().value(QLatin1String("X-KDE-PlasmaComicProvider-SuffixType"));
-    if (type == QLatin1String("Date")) {
-        result = ComicProvider::DateIdentifier;
-    } else if (type == QLatin1String("Number")) {
-        result = ComicProvider::NumberIdentifier;
-    } else if (type == QLatin1String("String")) {
-        result = ComicProvider::StringIdentifier;
-    }
-    return result;
+    return mIdentifierType;
 }
 
-QImage ComicProviderWrapper::comicImage()
+ComicScriptResult ComicProviderWrapper::collectResult()
 {
+    ComicScriptResult result;
+
     ImageWrapper *img = qobject_cast<ImageWrapper *>(callFunction(QLatin1String("image")).value<QObject *>());
     if (functionCalled() && img) {
-        return img->image();
-    }
-    if (mKrossImage) {
-        return mKrossImage->image();
+        result.image = img->image();
+    } else if (mKrossImage) {
+        result.image = mKrossImage->image();
     }
-    return QImage();
+
+    result.comicAuthor = mComicAuthor;
+    result.websiteUrl = mWebsiteUrl;
+    result.shopUrl = mShopUrl;
+    result.title = mTitle;
+    result.additionalText = mAdditionalText;
+    result.identifier = identifierVariant();
+    result.nextIdentifier = nextIdentifierVariant();
+    result.previousIdentifier = previousIdentifierVariant();
+    result.firstIdentifier = firstIdentifierVariant();
+    result.isLeftToRight = mIsLeftToRight;
+    result.isTopToBottom = mIsTopToBottom;
+    return result;
 }
 
 QJSValue ComicProviderWrapper::identifierToScript(const QVariant &identifier)
@@ -414,15 +445,15 @@ void ComicProviderWrapper::setIdentifierToDefault()
 {
     switch (identifierType()) {
     case ComicProvider::DateIdentifier:
-        mIdentifier = mProvider->requestedDate();
+        mIdentifier = mRequestedIdentifier;
         mLastIdentifier = QDate::currentDate();
         break;
     case ComicProvider::NumberIdentifier:
-        mIdentifier = mProvider->requestedNumber();
+        mIdentifier = mRequestedIdentifier;
         mFirstIdentifier = 1;
         break;
     case ComicProvider::StringIdentifier:
-        mIdentifier = mProvider->requestedString();
+        mIdentifier = mRequestedIdentifier;
         break;
     }
 }
@@ -464,12 +495,12 @@ void ComicProviderWrapper::setTextCodec(const QString &textCodec)
 
 QString ComicProviderWrapper::comicAuthor() const
 {
-    return mProvider->comicAuthor();
+    return mComicAuthor;
 }
 
 void ComicProviderWrapper::setComicAuthor(const QString &author)
 {
-    mProvider->setComicAuthor(author);
+    mComicAuthor = author;
 }
 
 QString ComicProviderWrapper::websiteUrl() const
@@ -558,16 +589,7 @@ QJSValue ComicProviderWrapper::firstIdentifier()
 
 void ComicProviderWrapper::setFirstIdentifier(const QJSValue &firstIdentifier)
 {
-    switch (identifierType()) {
-    case ComicProvider::DateIdentifier:
-        mProvider->setFirstStripDate(DateWrapper::fromVariant(QVariant::fromValue(firstIdentifier.toQObject())));
-        break;
-    case ComicProvider::NumberIdentifier:
-        mProvider->setFirstStripNumber(firstIdentifier.toInt());
-        break;
-    case ComicProvider::StringIdentifier:
-        break;
-    }
+    // the provider takes the first strip over from the result
     mFirstIdentifier = identifierFromScript(firstIdentifier);
     checkIdentifier(&mIdentifier);
 }
@@ -711,7 +733,7 @@ void ComicProviderWrapper::pageError(int id, const QString &message)
     --mRequests;
     callFunction(QLatin1String("pageError"), {id, message});
     if (!functionCalled()) {
-        Q_EMIT mProvider->error(mProvider);
+        error();
     }
 }
 
@@ -724,7 +746,7 @@ void ComicProviderWrapper::redirected(int id, const QUrl &newUrl)
     }
 }
 
-void ComicProviderWrapper::finished() const
+void ComicProviderWrapper::finished()
 {
     qCDebug(PLASMA_COMIC) << QString::fromLatin1("Author").leftJustified(22, QLatin1Char('.')) << comicAuthor();
     qCDebug(PLASMA_COMIC) << QString::fromLatin1("Website URL").leftJustified(22, QLatin1Char('.')) << mWebsiteUrl;
@@ -736,33 +758,29 @@ void ComicProviderWrapper::finished() const
     qCDebug(PLASMA_COMIC) << QString::fromLatin1("Last Identifier").leftJustified(22, QLatin1Char('.')) << mLastIdentifier;
     qCDebug(PLASMA_COMIC) << QString::fromLatin1("Next Identifier").leftJustified(22, QLatin1Char('.')) << mNextIdentifier;
     qCDebug(PLASMA_COMIC) << QString::fromLatin1("Previous Identifier").leftJustified(22, QLatin1Char('.')) << mPreviousIdentifier;
-    Q_EMIT mProvider->finished(mProvider);
+    Q_EMIT stripFinished(collectResult());
 }
 
-void ComicProviderWrapper::error() const
+void ComicProviderWrapper::error()
 {
-    Q_EMIT mProvider->error(mProvider);
+    Q_EMIT stripFailed(collectResult());
 }
 
 void ComicProviderWrapper::requestPage(const QString &url, int id, const QVariantMap &infos)
 {
-    QMap<QString, QString> map;
-
-    for (auto it = infos.begin(), end = infos.end(); it != end; ++it) {
-        map[it.key()] = it.value().toString();
+    if (id == ComicProvider::Image && mIsProbe) {
+        // the identifier is known once the image is requested, no need to download it
+        QTimer::singleShot(0, this, &ComicProviderWrapper::finished);
+        return;
     }
-    mProvider->requestPage(QUrl(url), id, map);
+
+    Q_EMIT pageRequested(QUrl(url), id, infos);
     ++mRequests;
 }
 
 void ComicProviderWrapper::requestRedirectedUrl(const QString &url, int id, const QVariantMap &infos)
 {
-    QMap<QString, QString> map;
-
-    for (auto it = infos.begin(), end = infos.end(); it != end; ++it) {
-        map[it.key()] = it.value().toString();
-    }
-    mProvider->requestRedirectedUrl(QUrl(url), id, map);
+    Q_EMIT redirectedUrlRequested(QUrl(url), id, infos);
     ++mRequests;
 }
 
@@ -776,8 +794,12 @@ QVariant ComicProviderWrapper::callFunction(const QString &name, const QJSValueL
     if (m_engine) {
         mFuncFound = mFunctions.contains(name);
         if (mFuncFound) {
-            auto val = m_engine->globalObject().property(name).call(args);
-            if (val.isError()) {
+            auto val = m_script->call(name, args);
+            if (m_script->wasInterrupted()) {
+                // a runaway script, do not wait for the provider timeout
+                QTimer::singleShot(0, this, &ComicProviderWrapper::error);
+                return QVariant();
+            } else if (val.isError()) {
                 qCWarning(PLASMA_COMIC) << "Error when calling function" << name << "with arguments" << QVariant::fromValue(args) << val.toString();
                 return QVariant();
             } else {
@@ -796,12 +818,16 @@ void ComicProviderWrapper::combine(const QVariant &image, PositionType position)
 
     QImage header;
     if (image.type() == QVariant::String) {
-        const QString path(mPackage->filePath("images", image.toString()));
-        if (QFile::exists(path)) {
-            header = QImage(path);
-        } else {
-            return;
+        // multi panel comics combine the same images over and over again
+        auto it = mPackageImages.constFind(image.toString());
+        if (it == mPackageImages.constEnd()) {
+            const QString path(mPackage->filePath("images", image.toString()));
+            if (!QFile::exists(path)) {
+                return;
+            }
+            it = mPackageImages.insert(image.toString(), QImage(path));
         }
+        header = *it;
     } else {
         ImageWrapper *img = qobject_cast<ImageWrapper *>(image.value<QObject *>());
         if (img) {
@@ -810,7 +836,11 @@ void ComicProviderWrapper::combine(const QVariant &image, PositionType position)
             return;
         }
     }
-    const QImage comic = mKrossImage->image();
+    mKrossImage->setImage(combineImages(header, mKrossImage->image(), position));
+}
+
+QImage ComicProviderWrapper::combineImages(const QImage &header, const QImage &comic, PositionType position)
+{
     int height = 0;
     int width = 0;
 
@@ -828,7 +858,11 @@ void ComicProviderWrapper::combine(const QVariant &image, PositionType position)
     }
 
     QImage img = QImage(QSize(width, height), QImage::Format_RGB32);
-    img.fill(header.pixel(QPoint(0, 0)));
+    // only the area not covered by the two images needs the background
+    const bool covered = (position == Top || position == Bottom) ? header.width() == comic.width() : header.height() == comic.height();
+    if (!covered || header.hasAlphaChannel() || comic.hasAlphaChannel()) {
+        img.fill(header.pixel(QPoint(0, 0)));
+    }
 
     QPainter painter(&img);
 
@@ -856,7 +890,8 @@ void ComicProviderWrapper::combine(const QVariant &image, PositionType position)
     }
     painter.drawImage(headerPos, header);
     painter.drawImage(comicPos, comic);
-    mKrossImage->setImage(img);
+    painter.end();
+    return img;
 }
 
 QObject *ComicProviderWrapper::image()
@@ -12,15 +12,19 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QHash>
 #include <QImage>
 #include <QImageReader>
 #include <QJSValue>
+#include <QUrl>
+#include <QVariant>
 
 namespace KPackage
 {
 class Package;
 }
 class ComicProviderKross;
+class PooledScriptEngine;
 class QJSEngine;
 
 class ImageWrapper : public QObject
@@ -31,11 +35,17 @@ class ImageWrapper : public QObject
 public:
     explicit ImageWrapper(QObject *parent = nullptr, const QByteArray &image = QByteArray());
 
+    /**
+     * Returns the image, the raw data is only decoded on first use
+     */
     QImage image() const;
     /**
      * Sets the image, rawData is changed to the new set image
      */
     void setImage(const QImage &image);
+    /**
+     * Returns the raw data, an image set with setImage is only encoded on first use
+     */
     QByteArray rawData() const;
 
     /**
@@ -62,12 +72,14 @@ public Q_SLOTS:
 
 private:
     void resetImageReader();
+    void ensureImageReader() const;
 
 private:
-    QImage mImage;
+    mutable QImage mImage;
     mutable QByteArray mRawData;
-    QBuffer mBuffer;
-    QImageReader mImageReader;
+    mutable bool mImageDecoded;
+    mutable QBuffer mBuffer;
+    mutable QImageReader mImageReader;
 };
 
 class DateWrapper
@@ -135,6 +147,33 @@ public Q_SLOTS:
     QString shortMonthName(int month);
 };
 
+/**
+ * What the script of a comic provider found out about a strip, handed from the
+ * script worker thread to the provider.
+ */
+struct ComicScriptResult {
+    QImage image;
+    QString comicAuthor;
+    QString websiteUrl;
+    QString shopUrl;
+    QString title;
+    QString additionalText;
+    QVariant identifier;
+    QVariant nextIdentifier;
+    QVariant previousIdentifier;
+    QVariant firstIdentifier;
+    bool isLeftToRight = true;
+    bool isTopToBottom = true;
+};
+Q_DECLARE_METATYPE(ComicScriptResult)
+
+/**
+ * The "comic" object of a comic provider script.
+ *
+ * It lives on the worker thread of ScriptEnginePool together with the script
+ * engine. It never touches the provider, page requests and results leave it
+ * through the signals below and downloaded pages come in through the slots.
+ */
 class ComicProviderWrapper : public QObject
 {
     Q_OBJECT
@@ -172,7 +211,10 @@ public:
     };
     Q_ENUM(RedirectedUrlType)
 
-    explicit ComicProviderWrapper(ComicProviderKross *parent);
+    /**
+     * Copies what the script needs to know about the request from @p provider.
+     */
+    explicit ComicProviderWrapper(const ComicProviderKross *provider);
     ~ComicProviderWrapper() override;
 
     int apiVersion() const
@@ -185,11 +227,13 @@ public:
         qWarning() << str.toString();
     }
 
+    /**
+     * Returns @p comic with @p header placed next to it at @p position, both centered
+     * on a canvas filled with the top left pixel of @p header where they leave a gap
+     */
+    static QImage combineImages(const QImage &header, const QImage &comic, PositionType position);
+
     ComicProvider::IdentifierType identifierType() const;
-    QImage comicImage();
-    void pageRetrieved(int id, const QByteArray &data);
-    void pageError(int id, const QString &message);
-    void redirected(int id, const QUrl &newUrl);
 
     bool identifierSpecified() const;
     QString textCodec() const;
@@ -225,9 +269,15 @@ public:
     QVariant nextIdentifierVariant() const;
     QVariant previousIdentifierVariant() const;
 
+Q_SIGNALS:
+    void pageRequested(const QUrl &url, int id, const QVariantMap &infos);
+    void redirectedUrlRequested(const QUrl &url, int id, const QVariantMap &infos);
+    void stripFinished(const ComicScriptResult &result);
+    void stripFailed(const ComicScriptResult &result);
+
 public Q_SLOTS:
-    void finished() const;
-    void error() const;
+    void finished();
+    void error();
 
     void requestPage(const QString &url, int id, const QVariantMap &infos = QVariantMap());
     void requestRedirectedUrl(const QString &url, int id, const QVariantMap &infos = QVariantMap());
@@ -236,6 +286,10 @@ public Q_SLOTS:
 
     void init();
 
+    void pageRetrieved(int id, const QByteArray &data);
+    void pageError(int id, const QString &message);
+    void redirected(int id, const QUrl &newUrl);
+
 protected:
     QVariant callFunction(const QString &name, const QJSValueList &args = {});
     bool functionCalled() const;
@@ -243,13 +297,20 @@ protected:
     QVariant identifierFromScript(const QJSValue &identifier) const;
     void setIdentifierToDefault();
     void checkIdentifier(QVariant *identifier);
+    ComicScriptResult collectResult();
 
 private:
+    PooledScriptEngine *m_script = nullptr;
     QJSEngine *m_engine = nullptr;
-    ComicProviderKross *mProvider;
+    QString mPluginName;
+    ComicProvider::IdentifierType mIdentifierType;
+    QVariant mRequestedIdentifier;
+    bool mIsProbe;
+    QString mComicAuthor;
     QStringList mFunctions;
     bool mFuncFound;
     ImageWrapper *mKrossImage;
+    QHash<QString, QImage> mPackageImages;
     static QStringList mExtensions;
     KPackage::Package *mPackage;
 
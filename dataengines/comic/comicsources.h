@@ -0,0 +1,21 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#ifndef COMIC_SOURCES_H
+#define COMIC_SOURCES_H
+
+#include <QLatin1String>
+
+/**
+ * Source names of the comic engine, shared with the comic applet.
+ */
+namespace ComicSources
+{
+// followed by the comic identifier, reports only the identifier of the latest strip
+static const QLatin1String PROBE_PREFIX("latest_strip:");
+}
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#include "scriptenginepool.h"
+#include "comic_debug.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJSEngine>
+#include <QJSValueIterator>
+
+// engines kept per script, browsing rarely has more than a couple of requests in flight
+static const int MAX_IDLE_ENGINES = 2;
+// idle engines are dropped after this many ms to not keep the memory forever
+static const int IDLE_EXPIRY = 5 * 60 * 1000;
+// a single call into a script must not hold up the worker thread for longer than this many ms
+static const int CALL_BUDGET = 3000;
+
+Q_GLOBAL_STATIC(ScriptEnginePool, s_pool)
+
+ScriptWatchdog::ScriptWatchdog(QObject *parent)
+    : QThread(parent)
+{
+}
+
+ScriptWatchdog::~ScriptWatchdog()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+
+void ScriptWatchdog::arm(QJSEngine *engine, int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_engine = engine;
+    m_deadline = QDeadlineTimer(msecs);
+    m_condition.wakeOne();
+}
+
+void ScriptWatchdog::disarm()
+{
+    QMutexLocker locker(&m_mutex);
+    m_engine = nullptr;
+    m_condition.wakeOne();
+}
+
+void ScriptWatchdog::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_quit) {
+        if (!m_engine) {
+            m_condition.wait(&m_mutex);
+        } else if (!m_condition.wait(&m_mutex, m_deadline) && m_engine && m_deadline.hasExpired()) {
+            m_engine->setInterrupted(true);
+            m_engine = nullptr;
+        }
+    }
+}
+
+PooledScriptEngine::PooledScriptEngine(const QString &scriptPath, const QDateTime &lastModified)
+    : m_engine(new QJSEngine)
+    , m_scriptPath(scriptPath)
+    , m_lastModified(lastModified)
+{
+}
+
+PooledScriptEngine::~PooledScriptEngine()
+{
+    delete m_engine;
+}
+
+bool PooledScriptEngine::evaluate()
+{
+    QFile f(m_scriptPath);
+    if (!f.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    arm();
+    const QJSValue result = m_engine->evaluate(QString::fromUtf8(f.readAll()), m_scriptPath);
+    disarm();
+    if (result.isError()) {
+        qCWarning(PLASMA_COMIC) << "Error when evaluating" << m_scriptPath << result.toString();
+    }
+
+    QJSValueIterator it(m_engine->globalObject());
+    while (it.hasNext()) {
+        it.next();
+        if (it.value().isCallable()) {
+            m_functions << it.name();
+        }
+        m_pristineGlobals.insert(it.name(), it.value());
+    }
+    m_evaluated = true;
+    return true;
+}
+
+QJSValue PooledScriptEngine::call(const QString &name, const QJSValueList &args)
+{
+    if (m_interrupted) {
+        return QJSValue(QJSValue::UndefinedValue);
+    }
+
+    arm();
+    const QJSValue result = m_engine->globalObject().property(name).call(args);
+    disarm();
+    return result;
+}
+
+void PooledScriptEngine::arm()
+{
+    // calls can nest when a script triggers a slot which calls back into the script
+    if (m_depth++ == 0) {
+        ScriptEnginePool::self()->watchdog()->arm(m_engine, CALL_BUDGET);
+    }
+}
+
+void PooledScriptEngine::disarm()
+{
+    if (--m_depth == 0) {
+        ScriptEnginePool::self()->watchdog()->disarm();
+        if (m_engine->isInterrupted()) {
+            qCWarning(PLASMA_COMIC) << "Aborted" << m_scriptPath << "after exceeding its time budget of" << CALL_BUDGET << "ms";
+            m_interrupted = true;
+        }
+    }
+}
+
+void PooledScriptEngine::reset()
+{
+    // This restores the bindings of the global object. The objects the provider
+    // exposes ("comic", "Comic" and "date") are created anew for every provider.
+    // Objects of the script itself that it modified in place, e.g. the properties
+    // of a global variable holding an object, keep their state though. Scripts
+    // relying on a fresh state of those would have to set them up in init().
+    QJSValue global = m_engine->globalObject();
+    QStringList added;
+    QJSValueIterator it(global);
+    while (it.hasNext()) {
+        it.next();
+        if (!m_pristineGlobals.contains(it.name())) {
+            added << it.name();
+        }
+    }
+    for (const QString &name : qAsConst(added)) {
+        global.deleteProperty(name);
+    }
+    for (auto it = m_pristineGlobals.cbegin(), end = m_pristineGlobals.cend(); it != end; ++it) {
+        global.setProperty(it.key(), it.value());
+    }
+    global.setProperty(QStringLiteral("comic"), QJSValue(QJSValue::UndefinedValue));
+    m_engine->collectGarbage();
+}
+
+ScriptEnginePool::ScriptEnginePool()
+    : m_worker(new QObject)
+{
+    m_thread.setObjectName(QStringLiteral("ComicScripts"));
+    m_worker->moveToThread(&m_thread);
+    m_thread.start();
+
+    m_expireTimer.setSingleShot(true);
+    m_expireTimer.setInterval(IDLE_EXPIRY);
+    connect(&m_expireTimer, &QTimer::timeout, this, &ScriptEnginePool::clear);
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ScriptEnginePool::clear);
+    }
+}
+
+ScriptEnginePool::~ScriptEnginePool()
+{
+    m_thread.quit();
+    m_thread.wait();
+    // nothing runs on the worker thread anymore, its engines can be deleted from here
+    deleteIdle();
+    delete m_worker;
+    delete m_watchdog;
+}
+
+ScriptEnginePool *ScriptEnginePool::self()
+{
+    return s_pool();
+}
+
+PooledScriptEngine *ScriptEnginePool::acquire(const QString &scriptPath)
+{
+    const QDateTime lastModified = QFileInfo(scriptPath).lastModified();
+
+    QVector<PooledScriptEngine *> &idle = m_idle[scriptPath];
+    while (!idle.isEmpty()) {
+        PooledScriptEngine *engine = idle.takeLast();
+        if (engine->m_lastModified == lastModified) {
+            qCDebug(PLASMA_COMIC) << "Reusing script engine for" << scriptPath;
+            return engine;
+        }
+        // the comic has been updated in the meantime
+        delete engine;
+    }
+
+    return new PooledScriptEngine(scriptPath, lastModified);
+}
+
+void ScriptEnginePool::release(PooledScriptEngine *engine)
+{
+    if (!engine) {
+        return;
+    }
+
+    QVector<PooledScriptEngine *> &idle = m_idle[engine->m_scriptPath];
+    if (!engine->isEvaluated() || engine->wasInterrupted() || idle.count() >= MAX_IDLE_ENGINES) {
+        delete engine;
+        return;
+    }
+
+    engine->reset();
+    idle.append(engine);
+    // the timer belongs to the thread the pool has been created on
+    QMetaObject::invokeMethod(this, [this]() {
+        m_expireTimer.start();
+    });
+}
+
+ScriptWatchdog *ScriptEnginePool::watchdog()
+{
+    if (!m_watchdog) {
+        m_watchdog = new ScriptWatchdog;
+        m_watchdog->start(QThread::LowPriority);
+    }
+    return m_watchdog;
+}
+
+QThread *ScriptEnginePool::workerThread()
+{
+    return &m_thread;
+}
+
+void ScriptEnginePool::clear()
+{
+    QMetaObject::invokeMethod(m_worker, [this]() {
+        deleteIdle();
+    });
+}
+
+void ScriptEnginePool::deleteIdle()
+{
+    for (const QVector<PooledScriptEngine *> &idle : qAsConst(m_idle)) {
+        qDeleteAll(idle);
+    }
+    m_idle.clear();
+}
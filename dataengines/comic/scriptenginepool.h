@@ -0,0 +1,186 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#ifndef SCRIPTENGINEPOOL_H
+#define SCRIPTENGINEPOOL_H
+
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QJSValue>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+
+class QJSEngine;
+
+/**
+ * Interrupts script engines that run longer than their budget.
+ *
+ * The scripts run on the worker thread of ScriptEnginePool, which keeps the
+ * shell responsive, but a runaway script would still hold up the scripts of
+ * all other comics. QJSEngine::setInterrupted() is safe to call from here.
+ */
+class ScriptWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ScriptWatchdog(QObject *parent = nullptr);
+    ~ScriptWatchdog() override;
+
+    /**
+     * Interrupts @p engine unless disarm() is called within @p msecs.
+     */
+    void arm(QJSEngine *engine, int msecs);
+    void disarm();
+
+protected:
+    void run() override;
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QJSEngine *m_engine = nullptr;
+    QDeadlineTimer m_deadline;
+    bool m_quit = false;
+};
+
+/**
+ * A script engine with a comic provider's main script already evaluated.
+ *
+ * Instances are handed out by ScriptEnginePool and have to be given back
+ * with ScriptEnginePool::release() once the strip request is done. They
+ * must only be used on the thread they have been acquired on.
+ */
+class PooledScriptEngine
+{
+public:
+    QJSEngine *engine() const
+    {
+        return m_engine;
+    }
+
+    /**
+     * Returns the names of the functions the script defines in the global object.
+     */
+    QStringList functions() const
+    {
+        return m_functions;
+    }
+
+    /**
+     * Returns true if the script has been evaluated in this engine already.
+     */
+    bool isEvaluated() const
+    {
+        return m_evaluated;
+    }
+
+    /**
+     * Evaluates the script this engine has been created for and remembers
+     * the resulting global object, so that it can be restored on release.
+     * The globals the script relies on (e.g. "comic") have to be set before.
+     *
+     * @return false if the script could not be read
+     */
+    bool evaluate();
+
+    /**
+     * Calls the global function @p name, aborting it if it exceeds the
+     * CPU time budget of a single script call.
+     */
+    QJSValue call(const QString &name, const QJSValueList &args = QJSValueList());
+
+    /**
+     * Returns true if a script call has been aborted because of its budget,
+     * such an engine is not reused.
+     */
+    bool wasInterrupted() const
+    {
+        return m_interrupted;
+    }
+
+private:
+    friend class ScriptEnginePool;
+
+    explicit PooledScriptEngine(const QString &scriptPath, const QDateTime &lastModified);
+    ~PooledScriptEngine();
+
+    void reset();
+    void arm();
+    void disarm();
+
+    QJSEngine *m_engine;
+    QString m_scriptPath;
+    QDateTime m_lastModified;
+    QStringList m_functions;
+    QHash<QString, QJSValue> m_pristineGlobals;
+    bool m_evaluated = false;
+    bool m_interrupted = false;
+    int m_depth = 0;
+};
+
+/**
+ * Keeps warmed-up script engines per comic provider script around, so that
+ * browsing through strips does not pay for a new QJSEngine and a full script
+ * evaluation on every request.
+ *
+ * The comic scripts run on the worker thread of the pool, the objects exposed
+ * to them are moved there and exchange requests and results with the providers
+ * through queued signals. acquire() and release() are called on that thread.
+ */
+class ScriptEnginePool : public QObject
+{
+    Q_OBJECT
+
+public:
+    ScriptEnginePool();
+    ~ScriptEnginePool() override;
+
+    static ScriptEnginePool *self();
+
+    /**
+     * Returns an engine for @p scriptPath, either an idle one from the pool or a new one.
+     * Engines whose script has been modified on disk in the meantime are discarded.
+     */
+    PooledScriptEngine *acquire(const QString &scriptPath);
+
+    /**
+     * Resets the global object of @p engine to the state right after the script
+     * was evaluated and keeps it for later requests.
+     */
+    void release(PooledScriptEngine *engine);
+
+    ScriptWatchdog *watchdog();
+
+    /**
+     * Returns the thread the comic scripts run on.
+     */
+    QThread *workerThread();
+
+public Q_SLOTS:
+    /**
+     * Drops all idle engines, they are deleted on the worker thread.
+     */
+    void clear();
+
+private:
+    void deleteIdle();
+
+    QHash<QString, QVector<PooledScriptEngine *>> m_idle;
+    QTimer m_expireTimer;
+    ScriptWatchdog *m_watchdog = nullptr;
+    QThread m_thread;
+    // lives on m_thread, the context for running code there
+    QObject *m_worker;
+};
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#include "noteindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+static const quint32 INDEX_VERSION = 1;
+static const int TITLE_LENGTH = 80;
+// matches of an incomplete word rank below matches of the whole word
+static const qreal PREFIX_WEIGHT = 0.5;
+
+NoteIndex::NoteIndex(const QString &notesPath)
+    : m_notesPath(notesPath)
+{
+}
+
+QString NoteIndex::indexPath() const
+{
+    return m_notesPath + QLatin1String("/.index");
+}
+
+QString NoteIndex::plainText(const QString &content)
+{
+    const QStringView html(content);
+    const QStringView start = html.trimmed();
+    if (!start.startsWith(QLatin1String("<!DOCTYPE"), Qt::CaseInsensitive) && !start.startsWith(QLatin1String("<html"), Qt::CaseInsensitive)) {
+        return content;
+    }
+
+    // the head only holds the style sheet
+    const int headEnd = content.indexOf(QLatin1String("</head>"), 0, Qt::CaseInsensitive);
+    int i = headEnd < 0 ? 0 : headEnd + 7;
+
+    QString text;
+    text.reserve(content.size() - i);
+    while (i < content.size()) {
+        const QChar c = content.at(i);
+        if (c == QLatin1Char('<')) {
+            const int end = content.indexOf(QLatin1Char('>'), i);
+            if (end < 0) {
+                break;
+            }
+            const QStringView tag = html.mid(i + 1, end - i - 1);
+            if (tag.startsWith(QLatin1String("br"), Qt::CaseInsensitive) || tag.startsWith(QLatin1String("/p"), Qt::CaseInsensitive)) {
+                text += QLatin1Char('\n');
+            }
+            i = end + 1;
+        } else if (c == QLatin1Char('&')) {
+            static const struct {
+                QLatin1String entity;
+                QLatin1String text;
+            } entities[] = {
+                {QLatin1String("&amp;"), QLatin1String("&")},
+                {QLatin1String("&lt;"), QLatin1String("<")},
+                {QLatin1String("&gt;"), QLatin1String(">")},
+                {QLatin1String("&quot;"), QLatin1String("\"")},
+                {QLatin1String("&#39;"), QLatin1String("'")},
+                {QLatin1String("&nbsp;"), QLatin1String(" ")},
+            };
+            const QStringView rest = html.mid(i);
+            const auto entity = std::find_if(std::begin(entities), std::end(entities), [rest](const auto &entity) {
+                return rest.startsWith(entity.entity);
+            });
+            if (entity != std::end(entities)) {
+                text += entity->text;
+                i += entity->entity.size();
+            } else {
+                text += c;
+                ++i;
+            }
+        } else {
+            text += c;
+            ++i;
+        }
+    }
+    return text;
+}
+
+bool NoteIndex::isNoteFile(const QString &path)
+{
+    const QString fileName = QFileInfo(path).fileName();
+
+    // the index and its temporary files are hidden
+    if (fileName.isEmpty() || fileName.startsWith(QLatin1Char('.'))) {
+        return false;
+    }
+
+    // QSaveFile writes to "<name>.XXXXXX" with six random letters or digits first
+    const int dot = fileName.lastIndexOf(QLatin1Char('.'));
+    if (dot > 0 && fileName.size() - dot - 1 == 6) {
+        const QStringView suffix = QStringView(fileName).mid(dot + 1);
+        const bool random = std::all_of(suffix.begin(), suffix.end(), [](QChar c) {
+            return c.unicode() < 128 && c.isLetterOrNumber();
+        });
+        if (random) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QStringList NoteIndex::tokenize(const QString &text)
+{
+    QStringList tokens;
+    int start = -1;
+    for (int i = 0; i <= text.size(); ++i) {
+        const bool isWordChar = i < text.size() && text.at(i).isLetterOrNumber();
+        if (isWordChar && start < 0) {
+            start = i;
+        } else if (!isWordChar && start >= 0) {
+            tokens.append(text.mid(start, i - start).toLower());
+            start = -1;
+        }
+    }
+    return tokens;
+}
+
+void NoteIndex::rememberIndexFile()
+{
+    const QFileInfo info(indexPath());
+    m_indexLastModified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+    m_indexSize = info.exists() ? info.size() : -1;
+}
+
+void NoteIndex::loadIfChanged()
+{
+    if (!m_loaded) {
+        load();
+        return;
+    }
+
+    const QFileInfo info(indexPath());
+    if (!info.exists() || (info.lastModified().toMSecsSinceEpoch() == m_indexLastModified && info.size() == m_indexSize)) {
+        return;
+    }
+
+    // saved by the other process, which might have seen changes we did not
+    const QSet<QString> unsavedIds = m_unsavedIds;
+    m_notes.clear();
+    m_postings.clear();
+    load();
+    for (const QString &id : unsavedIds) {
+        updateFile(QDir(m_notesPath).absoluteFilePath(id));
+    }
+}
+
+void NoteIndex::load()
+{
+    m_loaded = true;
+    m_unsavedIds.clear();
+    rememberIndexFile();
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 version;
+    quint32 count;
+    stream >> version >> count;
+    if (version != INDEX_VERSION) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString id;
+        Entry entry;
+        stream >> id >> entry.lastModified >> entry.size >> entry.title >> entry.terms;
+        insert(id, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring corrupt notes index" << file.fileName();
+        m_notes.clear();
+        m_postings.clear();
+    }
+    m_modified = false;
+}
+
+void NoteIndex::save()
+{
+    if (!m_modified) {
+        return;
+    }
+
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write notes index" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << INDEX_VERSION << quint32(m_notes.count());
+    for (auto it = m_notes.cbegin(), end = m_notes.cend(); it != end; ++it) {
+        stream << it.key() << it->lastModified << it->size << it->title << it->terms;
+    }
+    if (file.commit()) {
+        m_modified = false;
+        m_unsavedIds.clear();
+        rememberIndexFile();
+    }
+}
+
+void NoteIndex::insert(const QString &id, const Entry &entry)
+{
+    remove(id);
+    m_notes.insert(id, entry);
+    m_unsavedIds.insert(id);
+    for (auto it = entry.terms.cbegin(), end = entry.terms.cend(); it != end; ++it) {
+        m_postings[it.key()].insert(id, it.value());
+    }
+    m_modified = true;
+}
+
+bool NoteIndex::remove(const QString &id)
+{
+    const auto it = m_notes.constFind(id);
+    if (it == m_notes.constEnd()) {
+        return false;
+    }
+
+    for (auto term = it->terms.cbegin(), end = it->terms.cend(); term != end; ++term) {
+        auto posting = m_postings.find(term.key());
+        posting->remove(id);
+        if (posting->isEmpty()) {
+            m_postings.erase(posting);
+        }
+    }
+    m_notes.erase(it);
+    m_modified = true;
+    m_unsavedIds.insert(id);
+    return true;
+}
+
+bool NoteIndex::updateFile(const QString &path)
+{
+    loadIfChanged();
+
+    const QFileInfo info(path);
+    const QString id = info.fileName();
+    // the watch on the notes directory also reports the directory itself
+    if (!isNoteFile(path) || info.isDir()) {
+        return false;
+    }
+
+    if (!info.exists()) {
+        return remove(id);
+    }
+
+    const qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+    const auto it = m_notes.constFind(id);
+    if (it != m_notes.constEnd() && it->lastModified == lastModified && it->size == info.size()) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return remove(id);
+    }
+
+    const QString text = plainText(QString::fromUtf8(file.readAll()));
+
+    Entry entry;
+    entry.lastModified = lastModified;
+    entry.size = info.size();
+    const QStringList tokens = tokenize(text);
+    for (const QString &token : tokens) {
+        ++entry.terms[token];
+    }
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    for (const QString &line : lines) {
+        const QString title = line.simplified();
+        if (!title.isEmpty()) {
+            entry.title = title.left(TITLE_LENGTH);
+            break;
+        }
+    }
+
+    insert(id, entry);
+    return true;
+}
+
+bool NoteIndex::update()
+{
+    loadIfChanged();
+
+    bool changed = false;
+    QSet<QString> found;
+    const QFileInfoList files = QDir(m_notesPath).entryInfoList(QDir::Files);
+    for (const QFileInfo &info : files) {
+        if (!isNoteFile(info.absoluteFilePath())) {
+            continue;
+        }
+        found.insert(info.fileName());
+        changed = updateFile(info.absoluteFilePath()) || changed;
+    }
+
+    const QStringList ids = m_notes.keys();
+    for (const QString &id : ids) {
+        if (!found.contains(id)) {
+            changed = remove(id) || changed;
+        }
+    }
+    return changed;
+}
+
+QVector<NoteIndex::Result> NoteIndex::search(const QString &query, int limit) const
+{
+    const QStringList tokens = tokenize(query);
+    if (tokens.isEmpty() || m_notes.isEmpty()) {
+        return {};
+    }
+
+    QHash<QString, qreal> scores;
+    for (int i = 0; i < tokens.count(); ++i) {
+        const QString &token = tokens.at(i);
+        const bool last = i == tokens.count() - 1;
+
+        QHash<QString, qreal> tokenScores;
+        for (auto it = m_postings.lowerBound(token), end = m_postings.cend(); it != end && it.key().startsWith(token); ++it) {
+            const bool exact = it.key() == token;
+            if (!exact && !last) {
+                continue;
+            }
+            // rare words weigh more, repeated occurrences add less and less
+            const qreal idf = std::log(1 + qreal(m_notes.count()) / it->count());
+            for (auto note = it->cbegin(), noteEnd = it->cend(); note != noteEnd; ++note) {
+                tokenScores[note.key()] += idf * note.value() / (note.value() + 1.2) * (exact ? 1 : PREFIX_WEIGHT);
+            }
+        }
+
+        if (i == 0) {
+            scores = tokenScores;
+        } else {
+            // every word has to occur
+            for (auto it = scores.begin(); it != scores.end();) {
+                const auto tokenScore = tokenScores.constFind(it.key());
+                if (tokenScore == tokenScores.constEnd()) {
+                    it = scores.erase(it);
+                } else {
+                    it.value() += tokenScore.value();
+                    ++it;
+                }
+            }
+        }
+        if (scores.isEmpty()) {
+            return {};
+        }
+    }
+
+    QVector<Result> results;
+    results.reserve(scores.count());
+    qreal best = 0;
+    for (auto it = scores.cbegin(), end = scores.cend(); it != end; ++it) {
+        results.append(Result{it.key(), m_notes.value(it.key()).title, it.value()});
+        best = qMax(best, it.value());
+    }
+
+    std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+        return a.relevance > b.relevance;
+    });
+    if (results.count() > limit) {
+        results.resize(limit);
+    }
+    for (Result &result : results) {
+        result.relevance /= best;
+    }
+    return results;
+}
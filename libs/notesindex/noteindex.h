@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ */
+
+#ifndef NOTEINDEX_H
+#define NOTEINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * A full-text index over the notes in a directory.
+ *
+ * The index is kept next to the notes and only notes whose file changed since
+ * are read again. Searching does not touch the note files at all.
+ *
+ * Both the notes applet and the notes runner keep an index of the same notes.
+ * The file is replaced atomically on saving, and loaded again when another
+ * process saved it, before any further update.
+ *
+ * The class is not thread-safe, users on several threads have to lock.
+ */
+class NoteIndex
+{
+public:
+    struct Result {
+        QString id;
+        // first line of the note
+        QString title;
+        // between 0 and 1, the best result has 1
+        qreal relevance;
+    };
+
+    explicit NoteIndex(const QString &notesPath);
+
+    /**
+     * Indexes the notes that were added or modified since the last update
+     * and drops the removed ones.
+     *
+     * @return true if the index changed
+     */
+    bool update();
+
+    /**
+     * Reindexes the note file at @p path if it changed, or drops it if it is gone.
+     *
+     * @return true if the index changed
+     */
+    bool updateFile(const QString &path);
+
+    /**
+     * Returns the notes containing all words of @p query, the last word may be
+     * incomplete. The best matches come first.
+     */
+    QVector<Result> search(const QString &query, int limit = 20) const;
+
+    /**
+     * Writes the index to disk if it changed.
+     */
+    void save();
+
+    /**
+     * Returns the text of a note, which is stored as HTML by the applet.
+     */
+    static QString plainText(const QString &content);
+
+    /**
+     * Whether the file at @p path in the notes directory is a note. The index
+     * itself and the temporary files of atomic writes are not.
+     */
+    static bool isNoteFile(const QString &path);
+
+private:
+    struct Entry {
+        qint64 lastModified = 0;
+        qint64 size = -1;
+        QString title;
+        // number of occurrences of each word
+        QHash<QString, int> terms;
+    };
+
+    static QStringList tokenize(const QString &text);
+    QString indexPath() const;
+    void load();
+    void loadIfChanged();
+    void rememberIndexFile();
+    void insert(const QString &id, const Entry &entry);
+    bool remove(const QString &id);
+
+    const QString m_notesPath;
+    bool m_loaded = false;
+    bool m_modified = false;
+    // notes indexed since the last save, redone after loading the index of another process
+    QSet<QString> m_unsavedIds;
+    // modification time and size of the index file as last read or written by us
+    qint64 m_indexLastModified = -1;
+    qint64 m_indexSize = -1;
+    QHash<QString, Entry> m_notes;
+    // notes containing each word with its number of occurrences, sorted for prefix lookups
+    QMap<QString, QHash<QString, int>> m_postings;
+};
+
+#endif // NOTEINDEX_H
@@ -14,6 +14,11 @@
 #include <KSharedConfig>
 // Qt
 #include <QDebug>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+// Std
+#include <algorithm>
 
 AstronomicalEventsPlugin::AstronomicalEventsPlugin()
     : CalendarEvents::CalendarEventsPlugin()
@@ -29,40 +34,106 @@ AstronomicalEventsPlugin::~AstronomicalEventsPlugin()
 {
 }
 
+namespace
+{
+using Event = QPair<QDate, CalendarEvents::EventData>;
+
+/**
+ * The astronomical events of one year, sorted by date.
+ */
+struct YearEvents {
+    QVector<Event> lunarPhases;
+    QVector<Event> seasons;
+};
+
+CalendarEvents::EventData eventData(const QString &title)
+{
+    CalendarEvents::EventData data;
+    data.setIsAllDay(true);
+    data.setTitle(title);
+    data.setEventType(CalendarEvents::EventData::Event);
+    data.setIsMinor(false);
+    return data;
+}
+
+YearEvents computeYearEvents(int year)
+{
+    YearEvents events;
+
+    // consecutive lunar phases are at least six and a half days apart,
+    // so after one is found the next days need not be checked
+    const QDate end(year, 12, 31);
+    for (QDate date(year, 1, 1); date <= end;) {
+        const auto phase = KHolidays::LunarPhase::phaseAtDate(date);
+        if (phase != KHolidays::LunarPhase::None) {
+            events.lunarPhases.append({date, eventData(KHolidays::LunarPhase::phaseName(phase))});
+            date = date.addDays(6);
+        } else {
+            date = date.addDays(1);
+        }
+    }
+
+    const KHolidays::AstroSeasons::Season seasons[] = {
+        KHolidays::AstroSeasons::MarchEquinox,
+        KHolidays::AstroSeasons::JuneSolstice,
+        KHolidays::AstroSeasons::SeptemberEquinox,
+        KHolidays::AstroSeasons::DecemberSolstice,
+    };
+    for (const auto season : seasons) {
+        const QDate date = KHolidays::AstroSeasons::seasonDate(season, year);
+        if (date.isValid()) {
+            events.seasons.append({date, eventData(KHolidays::AstroSeasons::seasonName(season))});
+        }
+    }
+
+    return events;
+}
+
+// the events only depend on the year, so they are shared by all calendars
+using YearEventsCache = QHash<int, YearEvents>;
+Q_GLOBAL_STATIC(YearEventsCache, s_yearEvents)
+
+const YearEvents &yearEvents(int year)
+{
+    auto it = s_yearEvents->find(year);
+    if (it == s_yearEvents->end()) {
+        it = s_yearEvents->insert(year, computeYearEvents(year));
+    }
+    return *it;
+}
+
+void insertEvents(const QVector<Event> &events, const QDate &startDate, const QDate &endDate, QMultiHash<QDate, CalendarEvents::EventData> &data)
+{
+    auto it = std::lower_bound(events.cbegin(), events.cend(), startDate, [](const Event &event, const QDate &date) {
+        return event.first < date;
+    });
+    for (; it != events.cend() && it->first <= endDate; ++it) {
+        data.insert(it->first, it->second);
+    }
+}
+}
+
 void AstronomicalEventsPlugin::loadEventsForDateRange(const QDate &startDate, const QDate &endDate)
 {
     QMultiHash<QDate, CalendarEvents::EventData> data;
 
-    if (!endDate.isValid()) {
+    if (!startDate.isValid() || !endDate.isValid()) {
         Q_EMIT dataReady(data);
         return;
     }
 
-    for (QDate date = startDate; date <= endDate && date.isValid(); date = date.addDays(1)) {
-        if (m_lunarPhaseShown) {
-            const auto phase = KHolidays::LunarPhase::phaseAtDate(date);
-            if (phase != KHolidays::LunarPhase::None) {
-                CalendarEvents::EventData lunarPhaseData;
-                lunarPhaseData.setIsAllDay(true);
-                lunarPhaseData.setTitle(KHolidays::LunarPhase::phaseName(phase));
-                lunarPhaseData.setEventType(CalendarEvents::EventData::Event);
-                lunarPhaseData.setIsMinor(false);
-
-                data.insert(date, lunarPhaseData);
-            }
+    for (int year = startDate.year(); year <= endDate.year(); ++year) {
+        // there is no year 0 in QDate
+        if (year == 0) {
+            continue;
         }
 
+        const YearEvents &events = yearEvents(year);
+        if (m_lunarPhaseShown) {
+            insertEvents(events.lunarPhases, startDate, endDate, data);
+        }
         if (m_seasonShown) {
-            const auto season = KHolidays::AstroSeasons::seasonAtDate(date);
-            if (season != KHolidays::AstroSeasons::None) {
-                CalendarEvents::EventData seasonData;
-                seasonData.setIsAllDay(true);
-                seasonData.setTitle(KHolidays::AstroSeasons::seasonName(season));
-                seasonData.setEventType(CalendarEvents::EventData::Event);
-                seasonData.setIsMinor(false);
-
-                data.insert(date, seasonData);
-            }
+            insertEvents(events.seasons, startDate, endDate, data);
         }
     }
 
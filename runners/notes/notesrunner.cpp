@@ -0,0 +1,92 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "notesrunner.h"
+
+#include <QClipboard>
+#include <QFile>
+#include <QGuiApplication>
+#include <QStandardPaths>
+
+#include <KDirWatch>
+#include <KLocalizedString>
+
+K_PLUGIN_CLASS_WITH_JSON(NotesRunner, "plasma-runner-notes.json")
+
+NotesRunner::NotesRunner(QObject *parent, const KPluginMetaData &metaData, const QVariantList &args)
+    : Plasma::AbstractRunner(parent, metaData, args)
+    , m_notesPath(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma_notes"))
+    , m_index(m_notesPath)
+{
+    setObjectName(QStringLiteral("Notes"));
+    setMinLetterCount(3);
+
+    addSyntax(Plasma::RunnerSyntax(QStringLiteral(":q:"), i18n("Finds notes containing all words of :q:.")));
+
+    m_notesWatch = new KDirWatch(this);
+    m_notesWatch->addDir(m_notesPath, KDirWatch::WatchFiles);
+    connect(m_notesWatch, &KDirWatch::dirty, this, &NotesRunner::fileChanged);
+    connect(m_notesWatch, &KDirWatch::created, this, &NotesRunner::fileChanged);
+    connect(m_notesWatch, &KDirWatch::deleted, this, &NotesRunner::fileChanged);
+}
+
+void NotesRunner::fileChanged(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_changedFiles.insert(path);
+}
+
+void NotesRunner::match(Plasma::RunnerContext &context)
+{
+    QVector<NoteIndex::Result> results;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // only the notes changed since the last query are read again
+        bool changed = false;
+        if (!m_indexUpToDate) {
+            m_indexUpToDate = true;
+            m_changedFiles.clear();
+            changed = m_index.update();
+        }
+        for (const QString &path : qAsConst(m_changedFiles)) {
+            changed = m_index.updateFile(path) || changed;
+        }
+        m_changedFiles.clear();
+        if (changed) {
+            m_index.save();
+        }
+
+        results = m_index.search(context.query());
+    }
+
+    if (!context.isValid()) {
+        return;
+    }
+
+    for (const NoteIndex::Result &result : qAsConst(results)) {
+        Plasma::QueryMatch match(this);
+        match.setType(Plasma::QueryMatch::PossibleMatch);
+        match.setRelevance(result.relevance * 0.8);
+        match.setIconName(QStringLiteral("knotes"));
+        match.setData(m_notesPath + QLatin1Char('/') + result.id);
+        match.setText(result.title.isEmpty() ? i18n("Empty note") : result.title);
+        match.setSubtext(i18n("Copy note to clipboard"));
+        context.addMatch(match);
+    }
+}
+
+void NotesRunner::run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &match)
+{
+    Q_UNUSED(context)
+
+    QFile file(match.data().toString());
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QGuiApplication::clipboard()->setText(NoteIndex::plainText(QString::fromUtf8(file.readAll())));
+    }
+}
+
+#include "notesrunner.moc"
@@ -0,0 +1,42 @@
+/*
+ *   SPDX-FileCopyrightText: 2021 KDE Plasma Addons contributors
+ *
+ *   SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef NOTESRUNNER_H
+#define NOTESRUNNER_H
+
+#include <KRunner/AbstractRunner>
+
+#include <QMutex>
+#include <QSet>
+
+#include "noteindex.h"
+
+class KDirWatch;
+
+class NotesRunner : public Plasma::AbstractRunner
+{
+    Q_OBJECT
+
+public:
+    explicit NotesRunner(QObject *parent, const KPluginMetaData &metaData, const QVariantList &args);
+
+    void match(Plasma::RunnerContext &context) override;
+    void run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &match) override;
+
+private:
+    void fileChanged(const QString &path);
+
+    QString m_notesPath;
+    KDirWatch *m_notesWatch = nullptr;
+
+    // matching happens on several threads, the index and the changes are guarded
+    QMutex m_mutex;
+    NoteIndex m_index;
+    bool m_indexUpToDate = false;
+    QSet<QString> m_changedFiles;
+};
+
+#endif